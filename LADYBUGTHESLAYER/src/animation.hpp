@@ -0,0 +1,150 @@
+#pragma once
+
+#include <SDL.h>
+#include "batch.hpp"
+#include "helper.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gmtk {
+	using ClipId = uint16_t;
+	static constexpr ClipId invalidClip = UINT16_MAX;
+
+	struct AnimationClip {
+		uint32_t firstFrame;
+		uint32_t frameCount;
+		float frameDuration; // ms per frame
+		bool repeat;
+	};
+
+	/**
+	 * Immutable-after-load clip table shared by every sprite using the same sheet
+	 * Frames of all clips live in one array; names are only looked at while loading
+	 */
+	class AnimationSet {
+	public:
+		explicit AnimationSet(Texture spritesheet, double scale = 3.0) : spritesheet(spritesheet), scale(scale) {}
+
+		// same layout as the old addAnimation: frames are laid out left to right starting at column x
+		ClipId addClip(std::string_view name, int frames, int x, int y, int w, int h, float frameDuration = 100.0f, bool repeat = true) {
+			std::vector<SDL_Rect> rects;
+			for (int i = 0; i < frames; ++i)
+				rects.push_back({(i + x) * w, y, w, h});
+
+			return addClip(name, rects, frameDuration, repeat);
+		}
+
+		ClipId addClip(std::string_view name, const std::vector<SDL_Rect> &rects, float frameDuration = 100.0f, bool repeat = true) {
+			ClipId id = static_cast<ClipId>(clips.size());
+			clips.push_back({static_cast<uint32_t>(frames.size()), static_cast<uint32_t>(rects.size()), frameDuration, repeat});
+			frames.insert(frames.end(), rects.begin(), rects.end());
+			names.push_back(std::basic_string<char>(name));
+			return id;
+		}
+
+		// resolve once at load time and keep the id around
+		ClipId find(std::string_view name) const noexcept {
+			for (size_t i = 0; i < names.size(); ++i) {
+				if (names[i] == name)
+					return static_cast<ClipId>(i);
+			}
+			return invalidClip;
+		}
+
+		const AnimationClip &clip(ClipId id) const { return clips[id]; }
+		const SDL_Rect &frame(ClipId id, uint32_t index) const { return frames[clips[id].firstFrame + index]; }
+		size_t clipCount() const noexcept { return clips.size(); }
+
+	public:
+		Texture spritesheet;
+		double scale;
+
+	private:
+		std::vector<SDL_Rect> frames;
+		std::vector<AnimationClip> clips;
+		std::vector<std::basic_string<char>> names;
+	};
+
+	struct AnimationState {
+		ClipId clip {invalidClip};
+		uint16_t frame {0};
+		float timer {0.0f};
+	};
+
+	// steps state forward by dt ms, shared by Animation and the ecs animation system
+	inline void advance(const AnimationSet &set, AnimationState &state, float dt) noexcept {
+		if (state.clip == invalidClip)
+			return;
+
+		const auto &clip = set.clip(state.clip);
+		if (clip.frameCount <= 1 || clip.frameDuration <= 0.0f)
+			return;
+
+		state.timer += dt;
+		while (state.timer >= clip.frameDuration) {
+			state.timer -= clip.frameDuration;
+
+			if (state.frame + 1u < clip.frameCount) {
+				++state.frame;
+			} else if (clip.repeat) {
+				state.frame = 0;
+			} else {
+				// play once clips hold their last frame
+				state.timer = 0.0f;
+				break;
+			}
+		}
+	}
+
+	/**
+	 * Per sprite playback: a pointer to the shared set plus clip / frame / timer
+	 */
+	class Animation {
+	public:
+		Animation() = default;
+		explicit Animation(std::shared_ptr<const AnimationSet> set) : set(std::move(set)) {}
+
+		void setAnimationSet(std::shared_ptr<const AnimationSet> newSet) {
+			set = std::move(newSet);
+			state = {};
+		}
+
+		void play(ClipId clip) noexcept {
+			if (state.clip != clip) {
+				state.clip = clip;
+				state.frame = 0;
+				state.timer = 0.0f;
+			}
+		}
+
+		void update(float dt) noexcept {
+			if (set != nullptr)
+				advance(*set, state, dt);
+		}
+
+		void draw(SpriteBatch &batch, int x, int y, int layer = 0) const {
+			if (set == nullptr || state.clip == invalidClip)
+				return;
+
+			const SDL_Rect &clip = set->frame(state.clip, state.frame);
+			batch.draw(set->spritesheet.get(), x, y, &clip, set->scale, set->scale, layer);
+		}
+
+		void draw(SDL_Renderer *ren, int x, int y) const {
+			if (set == nullptr || state.clip == invalidClip)
+				return;
+
+			SDL_Rect clip = set->frame(state.clip, state.frame);
+			drawTexture(set->spritesheet.get(), ren, x, y, &clip, set->scale, set->scale);
+		}
+
+		ClipId currentClip() const noexcept { return state.clip; }
+		uint32_t getCurrentFrame() const noexcept { return state.frame; }
+
+	private:
+		std::shared_ptr<const AnimationSet> set;
+		AnimationState state;
+	};
+} // namespace gmtk
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <SDL.h>
+#include "helper.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef GMTK_HAS_LZ4
+#include <lz4.h>
+#endif
+
+namespace gmtk {
+	/**
+	 * Packed asset file, little endian, built by assetpack:
+	 *   header: u32 magic 'GPAK', u32 version, u32 entries, u32 reserved, u64 toc offset
+	 *   blobs:  each starts on a blobAlign boundary
+	 *   toc:    per entry sorted by name: u64 offset, u64 stored size, u64 size, u32 flags, u16 name length, name
+	 */
+	struct ArchiveFormat {
+		static constexpr uint32_t magic = 0x4b415047; // "GPAK"
+		static constexpr uint32_t version = 1;
+		static constexpr uint32_t headerSize = 24;
+		static constexpr uint32_t blobAlign = 64;
+		static constexpr uint32_t lz4 = 1 << 0;
+	};
+
+	/**
+	 * Read only, memory mapped view of an archive
+	 * Stored entries are handed out as SDL_RWFromConstMem over the mapping, nothing is copied;
+	 * LZ4 entries are inflated once on first open and kept until the archive is closed
+	 */
+	class Archive {
+	public:
+		struct Entry {
+			std::string_view name; // points into the mapping
+			uint64_t offset;
+			uint64_t storedSize;
+			uint64_t size;
+			uint32_t flags;
+		};
+
+		Archive() = default;
+		~Archive() { close(); }
+
+		Archive(const Archive &) = delete;
+		Archive &operator=(const Archive &) = delete;
+
+		bool open(std::string_view filePath) {
+			close();
+
+			if (!map(std::basic_string<char>(filePath))) {
+				std::cout << "Failed to map archive: " << filePath << '\n';
+				return false;
+			}
+
+			if (!readToc()) {
+				std::cout << "Archive is corrupt or from another version: " << filePath << '\n';
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void close() {
+			if (mountedArchive() == this)
+				unmount();
+
+			entries.clear();
+			inflated.clear();
+			unmap();
+		}
+
+		/**
+		 * Routes openAsset (and so every loader) through this archive, files it doesn't have still come from disk
+		 * Mount before anything starts loading and keep the archive alive while its fonts and music are in use
+		 */
+		void mount() {
+			mountedArchive() = this;
+			assetOpener() = [](std::string_view filePath) -> SDL_RWops * {
+				return mountedArchive() != nullptr ? mountedArchive()->openRW(filePath) : nullptr;
+			};
+		}
+
+		void unmount() {
+			if (mountedArchive() != this)
+				return;
+
+			mountedArchive() = nullptr;
+			assetOpener() = nullptr;
+		}
+
+		const Entry *find(std::string_view name) const noexcept {
+			auto it = std::lower_bound(entries.begin(), entries.end(), name, [](const Entry &e, std::string_view n) {
+				return e.name < n;
+			});
+			return it != entries.end() && it->name == name ? &*it : nullptr;
+		}
+
+		// bytes of an entry, inflating it first if it's compressed; nullptr if it's missing or broken
+		const uint8_t *data(const Entry &entry) {
+			if ((entry.flags & ArchiveFormat::lz4) == 0)
+				return base + entry.offset;
+
+			std::lock_guard<std::mutex> lock(inflateMutex);
+
+			auto it = inflated.find(entry.name);
+			if (it != inflated.end())
+				return it->second.data();
+
+#ifdef GMTK_HAS_LZ4
+			std::vector<uint8_t> out(static_cast<size_t>(entry.size));
+			int n = LZ4_decompress_safe(reinterpret_cast<const char *>(base + entry.offset), reinterpret_cast<char *>(out.data()),
+				static_cast<int>(entry.storedSize), static_cast<int>(entry.size));
+			if (n < 0 || static_cast<uint64_t>(n) != entry.size) {
+				std::cout << "Failed to inflate archive entry: " << entry.name << '\n';
+				return nullptr;
+			}
+
+			return inflated.insert({entry.name, std::move(out)}).first->second.data();
+#else
+			std::cout << "Archive entry is LZ4 compressed but LZ4 support isn't built in: " << entry.name << '\n';
+			return nullptr;
+#endif
+		}
+
+		// nullptr when the archive doesn't have the file, safe to call from loader threads
+		SDL_RWops *openRW(std::string_view name) {
+			const Entry *entry = find(name);
+			if (entry == nullptr)
+				return nullptr;
+
+			const uint8_t *bytes = data(*entry);
+			if (bytes == nullptr)
+				return nullptr;
+
+			return SDL_RWFromConstMem(bytes, static_cast<int>(entry->size));
+		}
+
+		size_t size() const noexcept { return entries.size(); }
+		bool isOpen() const noexcept { return base != nullptr; }
+
+		template <typename F>
+		void forEach(F &&fn) const {
+			for (const auto &entry : entries)
+				fn(entry);
+		}
+
+	private:
+		static Archive *&mountedArchive() {
+			static Archive *archive = nullptr;
+			return archive;
+		}
+
+		template <typename T>
+		T read(uint64_t at) const noexcept {
+			T value;
+			std::memcpy(&value, base + at, sizeof(T));
+			return value;
+		}
+
+		bool readToc() {
+			if (length < ArchiveFormat::headerSize)
+				return false;
+
+			if (SDL_SwapLE32(read<uint32_t>(0)) != ArchiveFormat::magic || SDL_SwapLE32(read<uint32_t>(4)) != ArchiveFormat::version)
+				return false;
+
+			uint32_t count = SDL_SwapLE32(read<uint32_t>(8));
+			uint64_t at = SDL_SwapLE64(read<uint64_t>(16));
+			if (at > length)
+				return false;
+
+			// fixed part of an entry is 30 bytes, a count the rest of the file can't hold is garbage
+			if (count > (length - at) / 30)
+				return false;
+
+			entries.reserve(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				if (length - at < 30)
+					return false;
+
+				Entry entry;
+				entry.offset = SDL_SwapLE64(read<uint64_t>(at));
+				entry.storedSize = SDL_SwapLE64(read<uint64_t>(at + 8));
+				entry.size = SDL_SwapLE64(read<uint64_t>(at + 16));
+				entry.flags = SDL_SwapLE32(read<uint32_t>(at + 24));
+				uint16_t nameLength = SDL_SwapLE16(read<uint16_t>(at + 28));
+				at += 30;
+
+				if (length - at < nameLength || entry.offset > length || entry.storedSize > length - entry.offset || entry.size > INT32_MAX)
+					return false;
+
+				// stored entries are handed out as is, a bigger size would let readers run off the mapping
+				if ((entry.flags & ArchiveFormat::lz4) == 0 && entry.size != entry.storedSize)
+					return false;
+
+				// lz4 can't expand much past 255x, anything bigger would just be a huge allocation on load
+				if ((entry.flags & ArchiveFormat::lz4) != 0 && entry.size > entry.storedSize * 255 + 16)
+					return false;
+
+				entry.name = std::string_view(reinterpret_cast<const char *>(base + at), nameLength);
+				at += nameLength;
+
+				entries.push_back(entry);
+			}
+
+			// the packer writes them sorted, but find() depends on it so don't trust that
+			std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.name < b.name; });
+
+			return true;
+		}
+
+#ifdef _WIN32
+		bool map(const std::basic_string<char> &filePath) {
+			file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+				unmap();
+				return false;
+			}
+
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping == nullptr) {
+				unmap();
+				return false;
+			}
+
+			base = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			length = static_cast<uint64_t>(fileSize.QuadPart);
+			if (base == nullptr) {
+				unmap();
+				return false;
+			}
+
+			return true;
+		}
+
+		void unmap() {
+			if (base != nullptr)
+				UnmapViewOfFile(base);
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+
+			base = nullptr;
+			length = 0;
+			mapping = nullptr;
+			file = INVALID_HANDLE_VALUE;
+		}
+
+		HANDLE file {INVALID_HANDLE_VALUE};
+		HANDLE mapping {nullptr};
+#else
+		bool map(const std::basic_string<char> &filePath) {
+			int fd = ::open(filePath.c_str(), O_RDONLY);
+			if (fd < 0)
+				return false;
+
+			struct stat info;
+			if (fstat(fd, &info) != 0 || info.st_size == 0) {
+				::close(fd);
+				return false;
+			}
+
+			void *addr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			// the mapping keeps the file alive on its own
+			::close(fd);
+
+			if (addr == MAP_FAILED)
+				return false;
+
+			base = static_cast<const uint8_t *>(addr);
+			length = static_cast<uint64_t>(info.st_size);
+			return true;
+		}
+
+		void unmap() {
+			if (base != nullptr)
+				munmap(const_cast<uint8_t *>(base), static_cast<size_t>(length));
+
+			base = nullptr;
+			length = 0;
+		}
+#endif
+
+	private:
+		const uint8_t *base {nullptr};
+		uint64_t length {0};
+		std::vector<Entry> entries;
+
+		std::mutex inflateMutex;
+		std::unordered_map<std::string_view, std::vector<uint8_t>> inflated;
+	};
+} // namespace gmtk
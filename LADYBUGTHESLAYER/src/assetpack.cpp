@@ -0,0 +1,155 @@
+// packs a directory into an archive the game can mount:
+// assetpack [directory] [output] [--lz4]
+//
+// entries are named by their path as given, "assets/wall.png" packed from "assets" is looked up
+// as "assets/wall.png", the same string the loaders already use
+
+#include <SDL.h>
+#include "archive.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace gmtk;
+
+struct Input {
+	std::basic_string<char> name;
+	std::filesystem::path path;
+	uint64_t offset {0};
+	uint64_t storedSize {0};
+	uint64_t size {0};
+	uint32_t flags {0};
+};
+
+static void pad(SDL_RWops *rw, uint64_t &at) {
+	static const char zeros[ArchiveFormat::blobAlign] = {};
+	uint64_t aligned = (at + ArchiveFormat::blobAlign - 1) & ~static_cast<uint64_t>(ArchiveFormat::blobAlign - 1);
+	SDL_RWwrite(rw, zeros, 1, static_cast<size_t>(aligned - at));
+	at = aligned;
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<const char *> args;
+	bool useLz4 = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--lz4") == 0)
+			useLz4 = true;
+		else
+			args.push_back(argv[i]);
+	}
+
+	const char *directory = args.size() > 0 ? args[0] : "assets";
+	const char *output = args.size() > 1 ? args[1] : "assets.pak";
+
+#ifndef GMTK_HAS_LZ4
+	if (useLz4) {
+		std::printf("built without GMTK_HAS_LZ4, storing everything uncompressed\n");
+		useLz4 = false;
+	}
+#endif
+
+	std::error_code err;
+	std::vector<Input> inputs;
+	for (const auto &item : std::filesystem::recursive_directory_iterator(directory, err)) {
+		if (!item.is_regular_file())
+			continue;
+
+		Input input;
+		input.path = item.path();
+		input.name = item.path().generic_string();
+		inputs.push_back(std::move(input));
+	}
+
+	if (err) {
+		std::printf("Failed to read %s: %s\n", directory, err.message().c_str());
+		return 1;
+	}
+
+	std::sort(inputs.begin(), inputs.end(), [](const Input &a, const Input &b) { return a.name < b.name; });
+
+	SDL_RWops *rw = SDL_RWFromFile(output, "wb");
+	if (rw == nullptr) {
+		std::printf("Failed to open %s: %s\n", output, SDL_GetError());
+		return 1;
+	}
+
+	// header gets rewritten once the toc offset is known
+	uint64_t at = 0;
+	for (uint32_t i = 0; i < ArchiveFormat::headerSize; ++i)
+		SDL_WriteU8(rw, 0);
+	at += ArchiveFormat::headerSize;
+
+	uint64_t totalSize = 0, totalStored = 0;
+	for (auto &input : inputs) {
+		std::ifstream file(input.path, std::ios::binary);
+		std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (!file.good() && !file.eof()) {
+			std::printf("Failed to read %s\n", input.name.c_str());
+			SDL_RWclose(rw);
+			return 1;
+		}
+
+		input.size = bytes.size();
+		std::vector<char> compressed;
+
+#ifdef GMTK_HAS_LZ4
+		if (useLz4 && !bytes.empty()) {
+			compressed.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(bytes.size()))));
+			int n = LZ4_compress_default(bytes.data(), compressed.data(), static_cast<int>(bytes.size()), static_cast<int>(compressed.size()));
+
+			// pngs and oggs are already compressed, only keep it if it saves a real amount
+			if (n > 0 && static_cast<size_t>(n) < bytes.size() - bytes.size() / 8) {
+				compressed.resize(static_cast<size_t>(n));
+				input.flags |= ArchiveFormat::lz4;
+			} else {
+				compressed.clear();
+			}
+		}
+#endif
+
+		const auto &stored = (input.flags & ArchiveFormat::lz4) ? compressed : bytes;
+
+		pad(rw, at);
+		input.offset = at;
+		input.storedSize = stored.size();
+		SDL_RWwrite(rw, stored.data(), 1, stored.size());
+		at += stored.size();
+
+		totalSize += input.size;
+		totalStored += input.storedSize;
+	}
+
+	pad(rw, at);
+	uint64_t tocOffset = at;
+	for (const auto &input : inputs) {
+		SDL_WriteLE64(rw, input.offset);
+		SDL_WriteLE64(rw, input.storedSize);
+		SDL_WriteLE64(rw, input.size);
+		SDL_WriteLE32(rw, input.flags);
+		SDL_WriteLE16(rw, static_cast<uint16_t>(input.name.size()));
+		SDL_RWwrite(rw, input.name.data(), 1, input.name.size());
+	}
+
+	SDL_RWseek(rw, 0, RW_SEEK_SET);
+	SDL_WriteLE32(rw, ArchiveFormat::magic);
+	SDL_WriteLE32(rw, ArchiveFormat::version);
+	SDL_WriteLE32(rw, static_cast<uint32_t>(inputs.size()));
+	SDL_WriteLE32(rw, 0);
+	SDL_WriteLE64(rw, tocOffset);
+
+	if (SDL_RWclose(rw) != 0) {
+		std::printf("Failed to write %s: %s\n", output, SDL_GetError());
+		return 1;
+	}
+
+	std::printf("%s: %zu files, %llu bytes stored as %llu\n", output, inputs.size(),
+		static_cast<unsigned long long>(totalSize), static_cast<unsigned long long>(totalStored));
+
+	return 0;
+}
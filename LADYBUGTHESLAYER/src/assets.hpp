@@ -0,0 +1,415 @@
+#pragma once
+
+#include <SDL.h>
+#include "helper.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gmtk {
+	enum class AssetState : uint8_t {
+		loading,
+		ready,
+		failed,
+	};
+
+	/**
+	 * What callers hold while an asset loads in the background
+	 * get() hands back the placeholder until the main thread has finished the asset; main thread only
+	 */
+	template <typename T>
+	class AssetHandle {
+	public:
+		AssetHandle() = default;
+
+		std::shared_ptr<T> get() const noexcept {
+			if (slot == nullptr)
+				return nullptr;
+			return slot->state == AssetState::ready ? slot->asset : slot->placeholder;
+		}
+
+		AssetState state() const noexcept { return slot == nullptr ? AssetState::failed : slot->state; }
+		bool ready() const noexcept { return state() == AssetState::ready; }
+
+	private:
+		friend class AssetLoader;
+
+		struct Slot {
+			std::shared_ptr<T> asset;
+			std::shared_ptr<T> placeholder;
+			AssetState state {AssetState::loading};
+		};
+
+		std::shared_ptr<Slot> slot;
+	};
+
+	/**
+	 * Decodes images, sounds and font files on worker threads
+	 * Workers never touch the renderer or SDL_ttf; finished requests go through a lock-free queue
+	 * and pump() turns them into textures / fonts on the main thread within a time budget
+	 */
+	class AssetLoader {
+	public:
+		// 0 workers picks one less than the number of cores, at least 1 and at most 4
+		explicit AssetLoader(int workers = 0) : workerCount(workers) {
+			completedHead.store(&stub);
+			completedTail = &stub;
+		}
+
+		~AssetLoader() { shutdown(); }
+
+		AssetLoader(const AssetLoader &) = delete;
+		AssetLoader &operator=(const AssetLoader &) = delete;
+
+		// shown by texture handles until their image is uploaded
+		void setPlaceholder(Texture tex) { placeholder = std::move(tex); }
+
+		// 2x2 magenta / black checker, only as big as whoever draws it makes it
+		static Texture makePlaceholder(SDL_Renderer *ren) {
+			SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, 2, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+			if (surf == nullptr)
+				return nullptr;
+
+			SDL_Rect a = {0, 0, 1, 1}, b = {1, 1, 1, 1};
+			SDL_FillRect(surf, nullptr, SDL_MapRGBA(surf->format, 0, 0, 0, 255));
+			SDL_FillRect(surf, &a, SDL_MapRGBA(surf->format, 255, 0, 255, 255));
+			SDL_FillRect(surf, &b, SDL_MapRGBA(surf->format, 255, 0, 255, 255));
+
+			auto tex = Texture(SDL_CreateTextureFromSurface(ren, surf), SDL_DestroyTexture);
+			SDL_FreeSurface(surf);
+			return tex;
+		}
+
+		// the same path (and color key) always gets the same handle
+		AssetHandle<SDL_Texture> texture(std::string_view filePath, const SDL_Color *key = nullptr) {
+			std::basic_string<char> id(filePath);
+			if (key != nullptr) {
+				char suffix[10];
+				SDL_snprintf(suffix, sizeof(suffix), "#%02x%02x%02x%02x", key->r, key->g, key->b, key->a);
+				id += suffix;
+			}
+
+			auto it = textures.find(id);
+			if (it != textures.end())
+				return it->second;
+
+			AssetHandle<SDL_Texture> handle;
+			handle.slot = std::make_shared<AssetHandle<SDL_Texture>::Slot>();
+			handle.slot->placeholder = placeholder;
+			textures.insert({std::move(id), handle});
+
+			auto *req = new Request;
+			req->kind = Kind::texture;
+			req->path = filePath;
+			req->hasKey = key != nullptr;
+			req->key = key != nullptr ? *key : SDL_Color {0, 0, 0, 0};
+			req->slot = handle.slot;
+			submit(req);
+
+			return handle;
+		}
+
+		AssetHandle<Mix_Chunk> sound(std::string_view filePath) {
+			AssetHandle<Mix_Chunk> handle;
+			handle.slot = std::make_shared<AssetHandle<Mix_Chunk>::Slot>();
+
+			auto *req = new Request;
+			req->kind = Kind::sound;
+			req->path = filePath;
+			req->slot = handle.slot;
+			submit(req);
+
+			return handle;
+		}
+
+		/**
+		 * SDL_ttf isn't thread safe, so only the file read happens on a worker
+		 * The font is opened from memory by pump() and ends up in fontCache(), owned by it
+		 */
+		AssetHandle<TTF_Font> font(std::string_view fontFile, int fontSize, int outline = 0) {
+			AssetHandle<TTF_Font> handle;
+			handle.slot = std::make_shared<AssetHandle<TTF_Font>::Slot>();
+
+			auto *req = new Request;
+			req->kind = Kind::font;
+			req->path = fontFile;
+			req->fontSize = fontSize;
+			req->outline = outline;
+			req->slot = handle.slot;
+			submit(req);
+
+			return handle;
+		}
+
+		/**
+		 * Main thread, once per frame: finishes loaded assets until budgetMs is spent
+		 * At least one is finished per call so loading always makes progress; returns how many were
+		 */
+		size_t pump(SDL_Renderer *ren, double budgetMs = 2.0) {
+			auto start = std::chrono::steady_clock::now();
+			size_t finished = 0;
+
+			while (Request *req = popCompleted()) {
+				complete(req, ren);
+				delete req;
+				++finished;
+
+				if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs)
+					break;
+			}
+
+			return finished;
+		}
+
+		// blocks until every request so far is finished, for loading screens
+		void finish(SDL_Renderer *ren) {
+			while (pending() > 0) {
+				if (pump(ren, 1000.0) == 0)
+					std::this_thread::yield();
+			}
+		}
+
+		// requested but not yet finished by pump()
+		size_t pending() const noexcept { return inFlight.load(std::memory_order_acquire); }
+
+		/**
+		 * Stops the workers and drops everything still queued; textures die with the handles
+		 * Call it before the renderer is destroyed
+		 */
+		void shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+
+			for (auto &worker : workers)
+				worker.join();
+			workers.clear();
+
+			for (auto *req : queue)
+				delete req;
+			queue.clear();
+
+			while (Request *req = popCompleted()) {
+				if (req->surf != nullptr)
+					SDL_FreeSurface(req->surf);
+				if (req->chunk != nullptr)
+					Mix_FreeChunk(req->chunk);
+				delete req;
+			}
+
+			inFlight = 0;
+			textures.clear();
+			placeholder = nullptr;
+			stopping = false;
+		}
+
+	private:
+		enum class Kind : uint8_t {
+			texture,
+			sound,
+			font,
+		};
+
+		struct Request {
+			Kind kind;
+			std::basic_string<char> path;
+			bool hasKey {false};
+			SDL_Color key;
+			int fontSize {0};
+			int outline {0};
+			std::shared_ptr<void> slot;
+
+			// filled in by the worker
+			SDL_Surface *surf {nullptr};
+			Mix_Chunk *chunk {nullptr};
+			std::vector<char> data;
+
+			std::atomic<Request *> next {nullptr};
+		};
+
+		void submit(Request *req) {
+			inFlight.fetch_add(1, std::memory_order_relaxed);
+
+			// threads are only started once there is something to load
+			if (workers.empty()) {
+				int n = workerCount > 0 ? workerCount : std::max(1, std::min(SDL_GetCPUCount() - 1, 4));
+				for (int i = 0; i < n; ++i)
+					workers.emplace_back([this] { run(); });
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				queue.push_back(req);
+			}
+			wake.notify_one();
+		}
+
+		void run() {
+			for (;;) {
+				Request *req;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					wake.wait(lock, [this] { return stopping || !queue.empty(); });
+					if (stopping)
+						return;
+
+					req = queue.front();
+					queue.pop_front();
+				}
+
+				decode(*req);
+				pushCompleted(req);
+			}
+		}
+
+		// worker side, nothing here may touch the renderer
+		static void decode(Request &req) {
+			switch (req.kind) {
+				case Kind::texture:
+					req.surf = IMG_Load_RW(openAsset(req.path), 1);
+					if (req.surf != nullptr && req.hasKey)
+						SDL_SetColorKey(req.surf, SDL_TRUE, SDL_MapRGBA(req.surf->format, req.key.r, req.key.g, req.key.b, req.key.a));
+					break;
+
+				case Kind::sound:
+					req.chunk = Mix_LoadWAV_RW(openAsset(req.path), 1);
+					break;
+
+				case Kind::font: {
+					SDL_RWops *rw = openAsset(req.path);
+					if (rw == nullptr)
+						break;
+
+					Sint64 size = SDL_RWsize(rw);
+					if (size > 0) {
+						req.data.resize(static_cast<size_t>(size));
+						if (SDL_RWread(rw, req.data.data(), 1, req.data.size()) != req.data.size())
+							req.data.clear();
+					}
+					SDL_RWclose(rw);
+				} break;
+			}
+		}
+
+		// main thread side
+		void complete(Request *req, SDL_Renderer *ren) {
+			switch (req->kind) {
+				case Kind::texture: {
+					auto &slot = *std::static_pointer_cast<AssetHandle<SDL_Texture>::Slot>(req->slot);
+					if (req->surf == nullptr) {
+						std::cout << "Failed to load path: " << req->path << '\n';
+						slot.state = AssetState::failed;
+						break;
+					}
+
+					slot.asset = Texture(SDL_CreateTextureFromSurface(ren, req->surf), SDL_DestroyTexture);
+					SDL_FreeSurface(req->surf);
+					req->surf = nullptr;
+
+					if (slot.asset == nullptr)
+						std::cout << "Texture failed to be created: " << SDL_GetError() << '\n';
+
+					slot.state = slot.asset != nullptr ? AssetState::ready : AssetState::failed;
+				} break;
+
+				case Kind::sound: {
+					auto &slot = *std::static_pointer_cast<AssetHandle<Mix_Chunk>::Slot>(req->slot);
+					if (req->chunk == nullptr) {
+						std::cout << "Failed to load path: " << req->path << '\n';
+						slot.state = AssetState::failed;
+						break;
+					}
+
+					slot.asset = Chunk(req->chunk, Mix_FreeChunk);
+					req->chunk = nullptr;
+					slot.state = AssetState::ready;
+				} break;
+
+				case Kind::font: {
+					auto &slot = *std::static_pointer_cast<AssetHandle<TTF_Font>::Slot>(req->slot);
+					TTF_Font *font = nullptr;
+					if (!req->data.empty())
+						font = fontCache().adopt(req->path, req->fontSize, req->outline, std::move(req->data));
+
+					if (font == nullptr) {
+						std::cout << "Failed to load font: " << req->path << '\n';
+						slot.state = AssetState::failed;
+						break;
+					}
+
+					// fontCache() owns the font, the handle only points at it
+					slot.asset = std::shared_ptr<TTF_Font>(font, [](TTF_Font *) {});
+					slot.state = AssetState::ready;
+				} break;
+			}
+
+			inFlight.fetch_sub(1, std::memory_order_release);
+		}
+
+		// intrusive multi producer / single consumer queue (Vyukov), workers push and pump() pops
+		void pushCompleted(Request *req) {
+			req->next.store(nullptr, std::memory_order_relaxed);
+			Request *prev = completedHead.exchange(req, std::memory_order_acq_rel);
+			prev->next.store(req, std::memory_order_release);
+		}
+
+		Request *popCompleted() {
+			Request *tail = completedTail;
+			Request *next = tail->next.load(std::memory_order_acquire);
+
+			if (tail == &stub) {
+				if (next == nullptr)
+					return nullptr;
+				completedTail = next;
+				tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+
+			if (next != nullptr) {
+				completedTail = next;
+				return tail;
+			}
+
+			// a push is halfway done, pick it up next time
+			if (tail != completedHead.load(std::memory_order_acquire))
+				return nullptr;
+
+			// tail is the last node, put the stub back behind it so it can be handed out
+			pushCompleted(&stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next != nullptr) {
+				completedTail = next;
+				return tail;
+			}
+
+			return nullptr;
+		}
+
+	private:
+		int workerCount;
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::deque<Request *> queue;
+		bool stopping {false};
+
+		Request stub;
+		std::atomic<Request *> completedHead;
+		Request *completedTail;
+		std::atomic<size_t> inFlight {0};
+
+		std::unordered_map<std::basic_string<char>, AssetHandle<SDL_Texture>> textures;
+		Texture placeholder;
+	};
+} // namespace gmtk
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <SDL.h>
+#include "animation.hpp"
+#include "helper.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Binary atlas manifest, everything little endian:
+	 *   u32 magic 'GATL', u32 version
+	 *   u32 pages,   per page:   str file (relative to the manifest)
+	 *   u32 sprites, per sprite: str name, u16 page, i32 x y w h (where the source image landed)
+	 *   u32 clips,   per clip:   u16 sprite, str name, u32 frames, f32 ms per frame, u8 repeat,
+	 *                            then frames * i32 x y w h relative to the sprite
+	 * str is a u16 length followed by the bytes
+	 */
+	struct AtlasManifest {
+		static constexpr uint32_t magic = 0x4c544147; // "GATL"
+		static constexpr uint32_t version = 1;
+
+		struct Sprite {
+			std::basic_string<char> name;
+			uint16_t page;
+			SDL_Rect rect;
+		};
+
+		struct Clip {
+			uint16_t sprite;
+			std::basic_string<char> name;
+			float frameDuration;
+			bool repeat;
+			std::vector<SDL_Rect> frames;
+		};
+
+		std::vector<std::basic_string<char>> pages;
+		std::vector<Sprite> sprites;
+		std::vector<Clip> clips;
+
+		bool write(std::string_view filePath) const {
+			SDL_RWops *rw = SDL_RWFromFile(filePath.data(), "wb");
+			if (rw == nullptr) {
+				std::cout << "Failed to open manifest for writing: " << SDL_GetError() << '\n';
+				return false;
+			}
+
+			SDL_WriteLE32(rw, magic);
+			SDL_WriteLE32(rw, version);
+
+			SDL_WriteLE32(rw, static_cast<uint32_t>(pages.size()));
+			for (const auto &page : pages)
+				writeString(rw, page);
+
+			SDL_WriteLE32(rw, static_cast<uint32_t>(sprites.size()));
+			for (const auto &sprite : sprites) {
+				writeString(rw, sprite.name);
+				SDL_WriteLE16(rw, sprite.page);
+				writeRect(rw, sprite.rect);
+			}
+
+			SDL_WriteLE32(rw, static_cast<uint32_t>(clips.size()));
+			for (const auto &clip : clips) {
+				SDL_WriteLE16(rw, clip.sprite);
+				writeString(rw, clip.name);
+				SDL_WriteLE32(rw, static_cast<uint32_t>(clip.frames.size()));
+
+				uint32_t bits;
+				std::memcpy(&bits, &clip.frameDuration, sizeof(bits));
+				SDL_WriteLE32(rw, bits);
+				SDL_WriteU8(rw, clip.repeat ? 1 : 0);
+
+				for (const auto &frame : clip.frames)
+					writeRect(rw, frame);
+			}
+
+			return SDL_RWclose(rw) == 0;
+		}
+
+		bool read(std::string_view filePath) {
+			// through openAsset so a manifest packed into the mounted archive is found too
+			SDL_RWops *rw = openAsset(filePath);
+			if (rw == nullptr) {
+				std::cout << "Failed to open manifest: " << SDL_GetError() << '\n';
+				return false;
+			}
+
+			bool ok = read(rw);
+			SDL_RWclose(rw);
+
+			if (!ok)
+				std::cout << "Manifest is corrupt or from another version: " << filePath << '\n';
+
+			return ok;
+		}
+
+		bool read(SDL_RWops *rw) {
+			pages.clear();
+			sprites.clear();
+			clips.clear();
+
+			uint32_t head = 0, ver = 0;
+			if (!readU32(rw, head) || !readU32(rw, ver) || head != magic || ver != version)
+				return false;
+
+			uint32_t count = 0;
+			if (!readCount(rw, 2, count))
+				return false;
+			pages.resize(count);
+			for (auto &page : pages) {
+				if (!readString(rw, page))
+					return false;
+			}
+
+			if (!readCount(rw, 2 + 2 + 16, count))
+				return false;
+			sprites.reserve(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				Sprite sprite;
+				if (!readString(rw, sprite.name) || !readU16(rw, sprite.page) || !readRect(rw, sprite.rect))
+					return false;
+				if (sprite.page >= pages.size())
+					return false;
+
+				sprites.push_back(std::move(sprite));
+			}
+
+			if (!readCount(rw, 2 + 2 + 4 + 4 + 1, count))
+				return false;
+			clips.reserve(count);
+			for (uint32_t i = 0; i < count; ++i) {
+				Clip clip;
+				if (!readU16(rw, clip.sprite) || clip.sprite >= sprites.size() || !readString(rw, clip.name))
+					return false;
+
+				uint32_t frameCount = 0, bits = 0;
+				uint8_t repeat = 0;
+				if (!readU32(rw, frameCount) || !readU32(rw, bits) || !readU8(rw, repeat))
+					return false;
+				std::memcpy(&clip.frameDuration, &bits, sizeof(bits));
+				clip.repeat = repeat != 0;
+
+				if (frameCount > UINT16_MAX || frameCount > bytesLeft(rw) / 16)
+					return false;
+
+				clip.frames.resize(frameCount);
+				for (auto &frame : clip.frames) {
+					if (!readRect(rw, frame))
+						return false;
+				}
+
+				clips.push_back(std::move(clip));
+			}
+
+			return true;
+		}
+
+	private:
+		// more than any real atlas, for streams that can't tell how much is left
+		static constexpr uint32_t maxEntries = 1 << 20;
+
+		static void writeString(SDL_RWops *rw, const std::basic_string<char> &str) {
+			SDL_WriteLE16(rw, static_cast<uint16_t>(str.size()));
+			SDL_RWwrite(rw, str.data(), 1, str.size());
+		}
+
+		// the readers below fail on a short read, SDL_ReadLE* would hand back zeros at the end of the file
+		static bool readU8(SDL_RWops *rw, uint8_t &value) { return SDL_RWread(rw, &value, sizeof(value), 1) == 1; }
+
+		static bool readU16(SDL_RWops *rw, uint16_t &value) {
+			if (SDL_RWread(rw, &value, sizeof(value), 1) != 1)
+				return false;
+			value = SDL_SwapLE16(value);
+			return true;
+		}
+
+		static bool readU32(SDL_RWops *rw, uint32_t &value) {
+			if (SDL_RWread(rw, &value, sizeof(value), 1) != 1)
+				return false;
+			value = SDL_SwapLE32(value);
+			return true;
+		}
+
+		static bool readString(SDL_RWops *rw, std::basic_string<char> &str) {
+			uint16_t length = 0;
+			if (!readU16(rw, length))
+				return false;
+			str.resize(length);
+			return length == 0 || SDL_RWread(rw, &str[0], 1, length) == length;
+		}
+
+		static uint64_t bytesLeft(SDL_RWops *rw) {
+			Sint64 size = SDL_RWsize(rw), pos = SDL_RWtell(rw);
+			if (size < 0 || pos < 0 || pos > size)
+				return UINT64_MAX;
+			return static_cast<uint64_t>(size - pos);
+		}
+
+		// a count can't promise more entries than the rest of the file has room for
+		static bool readCount(SDL_RWops *rw, uint64_t minEntryBytes, uint32_t &count) {
+			return readU32(rw, count) && count <= maxEntries && count <= bytesLeft(rw) / minEntryBytes;
+		}
+
+		static void writeRect(SDL_RWops *rw, const SDL_Rect &rect) {
+			SDL_WriteLE32(rw, static_cast<uint32_t>(rect.x));
+			SDL_WriteLE32(rw, static_cast<uint32_t>(rect.y));
+			SDL_WriteLE32(rw, static_cast<uint32_t>(rect.w));
+			SDL_WriteLE32(rw, static_cast<uint32_t>(rect.h));
+		}
+
+		static bool readRect(SDL_RWops *rw, SDL_Rect &rect) {
+			uint32_t x = 0, y = 0, w = 0, h = 0;
+			if (!readU32(rw, x) || !readU32(rw, y) || !readU32(rw, w) || !readU32(rw, h))
+				return false;
+			rect = {static_cast<int>(x), static_cast<int>(y), static_cast<int>(w), static_cast<int>(h)};
+			return true;
+		}
+	};
+
+	struct AtlasSprite {
+		Texture page;
+		SDL_Rect clip;
+	};
+
+	/**
+	 * Texture pages plus named sprites and clips, built offline by atlaspack
+	 * Sprites that share a page share a texture, so the SpriteBatch can draw them in one call
+	 */
+	class Atlas {
+	public:
+		bool load(std::string_view manifestPath, SDL_Renderer *ren) {
+			clear();
+
+			if (!manifest.read(manifestPath))
+				return false;
+
+			// page files are stored relative to the manifest
+			std::basic_string<char> dir(manifestPath);
+			size_t slash = dir.find_last_of("/\\");
+			dir = slash == std::basic_string<char>::npos ? "" : dir.substr(0, slash + 1);
+
+			for (const auto &file : manifest.pages) {
+				auto tex = loadTexture(dir + file, ren);
+				if (tex == nullptr) {
+					clear();
+					return false;
+				}
+				pages.push_back(tex);
+			}
+
+			return true;
+		}
+
+		// page left empty if the sprite isn't in the atlas
+		AtlasSprite sprite(std::string_view name) const {
+			for (const auto &sprite : manifest.sprites) {
+				if (sprite.name == name)
+					return {pages[sprite.page], sprite.rect};
+			}
+			return {nullptr, {0, 0, 0, 0}};
+		}
+
+		/**
+		 * Every clip packed for the sprite, with frames moved to where the sprite sits on its page
+		 * Clip names stay the same so ids can be resolved with AnimationSet::find
+		 */
+		std::shared_ptr<AnimationSet> animationSet(std::string_view spriteName, double scale = 3.0) const {
+			for (size_t i = 0; i < manifest.sprites.size(); ++i) {
+				const auto &sprite = manifest.sprites[i];
+				if (sprite.name != spriteName)
+					continue;
+
+				auto set = std::make_shared<AnimationSet>(pages[sprite.page], scale);
+				std::vector<SDL_Rect> rects;
+
+				for (const auto &clip : manifest.clips) {
+					if (clip.sprite != i)
+						continue;
+
+					rects.clear();
+					for (const auto &frame : clip.frames)
+						rects.push_back({sprite.rect.x + frame.x, sprite.rect.y + frame.y, frame.w, frame.h});
+
+					set->addClip(clip.name, rects, clip.frameDuration, clip.repeat);
+				}
+
+				return set;
+			}
+
+			return nullptr;
+		}
+
+		size_t pageCount() const noexcept { return pages.size(); }
+
+		// must be called before the renderer is destroyed
+		void clear() {
+			pages.clear();
+			manifest = {};
+		}
+
+	private:
+		AtlasManifest manifest;
+		std::vector<Texture> pages;
+	};
+} // namespace gmtk
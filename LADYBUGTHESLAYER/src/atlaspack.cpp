@@ -0,0 +1,249 @@
+// packs the sprite sheets into atlas pages and writes the manifest the game loads:
+// atlaspack [spec file] [output manifest]
+//
+// spec lines, # starts a comment:
+//   sprite <name> <png>
+//   clip <name> <frames> <column> <y> <w> <h> <ms per frame> [once]
+// clips belong to the sprite above them and use the same layout as AnimationSet::addClip
+
+#include <SDL.h>
+#include "atlas.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gmtk;
+
+// the game's own sheets, used when no spec file is given
+static const char *defaultSpec = R"(
+sprite ladybug assets/ladybug.png
+clip Attack 7 0 0 32 27 100
+clip Idle 2 0 27 32 27 200
+clip Dead 1 2 27 32 27 0 once
+clip Run 2 7 27 32 27 150
+
+sprite wall assets/wall.png
+sprite rock assets/rock.png
+sprite particle assets/particle.png
+sprite dice assets/dice.png
+sprite warrior assets/warrior.png
+)";
+
+struct Source {
+	std::basic_string<char> name;
+	std::basic_string<char> file;
+	SDL_Surface *surf {nullptr};
+	uint16_t page {0};
+	SDL_Rect rect {0, 0, 0, 0};
+};
+
+static bool parseSpec(std::istream &in, std::vector<Source> &sources, AtlasManifest &manifest) {
+	std::basic_string<char> line;
+	int lineNumber = 0;
+
+	while (std::getline(in, line)) {
+		++lineNumber;
+		std::istringstream words(line.substr(0, line.find('#')));
+		std::basic_string<char> kind;
+		if (!(words >> kind))
+			continue;
+
+		if (kind == "sprite") {
+			Source src;
+			if (!(words >> src.name >> src.file)) {
+				std::printf("line %d: expected sprite <name> <png>\n", lineNumber);
+				return false;
+			}
+			sources.push_back(std::move(src));
+		} else if (kind == "clip") {
+			AtlasManifest::Clip clip;
+			int frames, column, y, w, h;
+			std::basic_string<char> once;
+
+			if (sources.empty() || !(words >> clip.name >> frames >> column >> y >> w >> h >> clip.frameDuration)) {
+				std::printf("line %d: expected clip <name> <frames> <column> <y> <w> <h> <ms> after a sprite\n", lineNumber);
+				return false;
+			}
+
+			if (frames <= 0 || column < 0 || y < 0 || w <= 0 || h <= 0) {
+				std::printf("line %d: clip %s needs at least one frame, a positive size and a non-negative column and y\n", lineNumber, clip.name.c_str());
+				return false;
+			}
+
+			clip.repeat = !(words >> once && once == "once");
+			clip.sprite = static_cast<uint16_t>(sources.size() - 1);
+			for (int i = 0; i < frames; ++i)
+				clip.frames.push_back({(i + column) * w, y, w, h});
+
+			manifest.clips.push_back(std::move(clip));
+		} else {
+			std::printf("line %d: unknown entry '%s'\n", lineNumber, kind.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Shelf packer: tallest first, left to right, opening a new shelf (then a new page) when full
+ * Returns the page heights actually used so pages can be trimmed
+ */
+static std::vector<int> pack(std::vector<Source> &sources, int pageSize, int padding) {
+	std::vector<Source *> order;
+	for (auto &src : sources)
+		order.push_back(&src);
+
+	std::stable_sort(order.begin(), order.end(), [](const Source *a, const Source *b) {
+		return a->rect.h > b->rect.h;
+	});
+
+	std::vector<int> heights;
+	int x = 0, y = 0, shelf = 0;
+
+	for (auto *src : order) {
+		int w = src->rect.w + padding, h = src->rect.h + padding;
+
+		if (heights.empty() || x + w > pageSize) {
+			// next shelf
+			y += shelf;
+			x = 0;
+			shelf = 0;
+		}
+
+		if (heights.empty() || y + h > pageSize) {
+			// next page; main() has already turned away anything bigger than a page
+			heights.push_back(0);
+			x = y = shelf = 0;
+		}
+
+		src->page = static_cast<uint16_t>(heights.size() - 1);
+		src->rect.x = x;
+		src->rect.y = y;
+
+		x += w;
+		shelf = std::max(shelf, h);
+		heights.back() = std::max(heights.back(), y + src->rect.h);
+	}
+
+	return heights;
+}
+
+int main(int argc, char **argv)
+{
+	const char *manifestPath = argc > 2 ? argv[2] : "assets/atlas.bin";
+	constexpr int pageSize = 2048, padding = 1;
+
+	SDL_assert(SDL_Init(0) == 0);
+	SDL_assert(IMG_Init(IMG_INIT_PNG) != 0);
+
+	std::vector<Source> sources;
+	AtlasManifest manifest;
+
+	bool parsed;
+	if (argc > 1) {
+		std::ifstream file(argv[1]);
+		if (!file) {
+			std::printf("Failed to open spec: %s\n", argv[1]);
+			return 1;
+		}
+		parsed = parseSpec(file, sources, manifest);
+	} else {
+		std::istringstream spec(defaultSpec);
+		parsed = parseSpec(spec, sources, manifest);
+	}
+
+	if (!parsed)
+		return 1;
+
+	for (auto &src : sources) {
+		src.surf = IMG_Load(src.file.c_str());
+		if (src.surf == nullptr) {
+			std::printf("Failed to load %s: %s\n", src.file.c_str(), SDL_GetError());
+			return 1;
+		}
+		src.rect.w = src.surf->w;
+		src.rect.h = src.surf->h;
+
+		// it would hang off the edge of any page, and a page is already as big as textures safely get
+		if (src.rect.w > pageSize || src.rect.h > pageSize) {
+			std::printf("%s is %dx%d, bigger than a %dx%d page; split it or leave it out of the atlas\n", src.file.c_str(), src.rect.w, src.rect.h, pageSize, pageSize);
+			return 1;
+		}
+	}
+
+	// frames are columns of w pixels, a clip reaching past its sheet would pick up whatever got packed beside it
+	for (const auto &clip : manifest.clips) {
+		const auto &src = sources[clip.sprite];
+		for (const auto &frame : clip.frames) {
+			if (frame.x + frame.w > src.rect.w || frame.y + frame.h > src.rect.h) {
+				std::printf("clip %s has a frame at %d,%d %dx%d, outside %s (%dx%d)\n", clip.name.c_str(), frame.x, frame.y, frame.w, frame.h, src.file.c_str(), src.rect.w, src.rect.h);
+				return 1;
+			}
+		}
+	}
+
+	auto heights = pack(sources, pageSize, padding);
+
+	// pages are written next to the manifest
+	std::basic_string<char> base(manifestPath);
+	size_t slash = base.find_last_of("/\\");
+	std::basic_string<char> dir = slash == std::basic_string<char>::npos ? "" : base.substr(0, slash + 1);
+	std::basic_string<char> stem = base.substr(dir.size());
+	stem = stem.substr(0, stem.rfind('.'));
+
+	for (size_t page = 0; page < heights.size(); ++page) {
+		int w = 0;
+		for (const auto &src : sources) {
+			if (src.page == page)
+				w = std::max(w, src.rect.x + src.rect.w);
+		}
+
+		SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, w, heights[page], 32, SDL_PIXELFORMAT_ARGB8888);
+		if (surf == nullptr) {
+			std::printf("Page failed to be created: %s\n", SDL_GetError());
+			return 1;
+		}
+		SDL_FillRect(surf, nullptr, 0);
+
+		for (auto &src : sources) {
+			if (src.page != page)
+				continue;
+
+			// copy alpha as is instead of blending onto the empty page
+			SDL_SetSurfaceBlendMode(src.surf, SDL_BLENDMODE_NONE);
+			SDL_Rect dst = src.rect;
+			SDL_BlitSurface(src.surf, nullptr, surf, &dst);
+		}
+
+		char name[256];
+		SDL_snprintf(name, sizeof(name), "%s%zu.png", stem.c_str(), page);
+		if (IMG_SavePNG(surf, (dir + name).c_str()) != 0) {
+			std::printf("Failed to save %s: %s\n", name, SDL_GetError());
+			SDL_FreeSurface(surf);
+			return 1;
+		}
+
+		SDL_FreeSurface(surf);
+		manifest.pages.push_back(name);
+		std::printf("%s%s %dx%d\n", dir.c_str(), name, w, heights[page]);
+	}
+
+	for (auto &src : sources) {
+		manifest.sprites.push_back({src.name, src.page, src.rect});
+		SDL_FreeSurface(src.surf);
+	}
+
+	if (!manifest.write(manifestPath))
+		return 1;
+
+	std::printf("%s: %zu sprites, %zu clips on %zu pages\n", manifestPath, manifest.sprites.size(), manifest.clips.size(), manifest.pages.size());
+
+	IMG_Quit();
+	SDL_Quit();
+
+	return 0;
+}
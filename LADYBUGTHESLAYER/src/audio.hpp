@@ -0,0 +1,233 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include "helper.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gmtk {
+	using SoundId = uint16_t;
+
+	/**
+	 * Sound effects by id over a fixed set of mixer channels, main thread only
+	 * Chunks are decoded once per file and shared by every id made from it
+	 * play() only queues; update() once a frame merges repeats of a sound, then hands out channels
+	 * by priority, so a pile of hits can't crowd out the sounds that matter
+	 */
+	class AudioManager {
+	public:
+		static constexpr SoundId invalid = UINT16_MAX;
+
+		struct Stats {
+			size_t played {0};
+			size_t coalesced {0}; // triggers merged into another of the same sound that frame
+			size_t capped {0}; // dropped for hitting maxInstances
+			size_t stolen {0}; // a quieter sound cut off to make room
+			size_t dropped {0}; // nothing worth stealing
+		};
+
+		// the mixer has to be open already; channels is how many voices this manager may use
+		explicit AudioManager(int channels = 32) : channelCount(Mix_AllocateChannels(channels)) {
+			voices.resize(channelCount);
+		}
+
+		AudioManager(const AudioManager &) = delete;
+		AudioManager &operator=(const AudioManager &) = delete;
+
+		~AudioManager() { clear(); }
+
+		/**
+		 * Loads (or reuses) filePath and registers it under name
+		 * Higher priority wins a channel; maxInstances caps how many copies play at once
+		 */
+		SoundId load(const std::basic_string<char> &name, std::string_view filePath, int priority = 0, int maxInstances = 4, float volume = 1.0f) {
+			auto named = ids.find(name);
+			if (named != ids.end())
+				return named->second;
+
+			std::basic_string<char> path(filePath);
+			Chunk chunk;
+			auto cached = bank.find(path);
+			if (cached != bank.end()) {
+				chunk = cached->second;
+			} else {
+				chunk = Chunk(Mix_LoadWAV_RW(openAsset(filePath), 1), Mix_FreeChunk);
+				if (chunk == nullptr) {
+					std::cout << "Failed to load sound " << path << ": " << Mix_GetError() << '\n';
+					return invalid;
+				}
+				bank.insert({path, chunk});
+			}
+
+			Sound sound;
+			sound.chunk = std::move(chunk);
+			sound.priority = priority;
+			sound.maxInstances = std::max(maxInstances, 1);
+			sound.volume = std::clamp(volume, 0.0f, 1.0f);
+
+			SoundId id = static_cast<SoundId>(sounds.size());
+			sounds.push_back(std::move(sound));
+			ids.insert({name, id});
+			return id;
+		}
+
+		SoundId find(const std::basic_string<char> &name) const {
+			auto it = ids.find(name);
+			return it != ids.end() ? it->second : invalid;
+		}
+
+		// queued until update(); the same sound more than once in a frame plays once, a bit louder
+		void play(SoundId id, float volume = 1.0f) {
+			if (id >= sounds.size())
+				return;
+
+			Sound &sound = sounds[id];
+			if (sound.pending == 0)
+				queue.push_back(id);
+			else
+				++lastStats.coalesced;
+
+			++sound.pending;
+			sound.pendingVolume = std::max(sound.pendingVolume, volume);
+		}
+
+		void play(const std::basic_string<char> &name, float volume = 1.0f) { play(find(name), volume); }
+
+		// call once a frame, after gameplay has queued its sounds
+		void update() {
+			++frame;
+			refresh();
+
+			if (queue.empty())
+				return;
+
+			// most important first, so they get the free channels and the least important get stolen from
+			std::sort(queue.begin(), queue.end(), [this](SoundId a, SoundId b) {
+				return sounds[a].priority > sounds[b].priority;
+			});
+
+			for (SoundId id : queue) {
+				Sound &sound = sounds[id];
+				// n stacked hits sound louder than one, but nowhere near n times
+				float boost = 1.0f + 0.15f * static_cast<float>(std::min(sound.pending - 1, 8));
+				float volume = std::min(sound.volume * sound.pendingVolume * boost, 1.0f);
+				sound.pending = 0;
+				sound.pendingVolume = 0.0f;
+
+				if (sound.playing >= sound.maxInstances) {
+					++lastStats.capped;
+					continue;
+				}
+
+				int channel = claim(sound.priority);
+				if (channel < 0) {
+					++lastStats.dropped;
+					continue;
+				}
+
+				Mix_Volume(channel, static_cast<int>(volume * MIX_MAX_VOLUME));
+				if (Mix_PlayChannel(channel, sound.chunk.get(), 0) < 0)
+					continue;
+
+				voices[channel] = {id, sound.priority, frame};
+				++sound.playing;
+				++lastStats.played;
+			}
+
+			queue.clear();
+		}
+
+		void stopAll() {
+			for (int i = 0; i < channelCount; ++i)
+				Mix_HaltChannel(i);
+			refresh();
+		}
+
+		// stops everything and frees the bank; safe to call again, the destructor does once the mixer is closed
+		void clear() {
+			// Mix_CloseAudio frees the channels, halting them after that touches freed mixer state
+			int frequency = 0, mixChannels = 0;
+			Uint16 format = 0;
+			if (!sounds.empty() && Mix_QuerySpec(&frequency, &format, &mixChannels) != 0)
+				stopAll();
+			std::fill(voices.begin(), voices.end(), Voice {});
+
+			queue.clear();
+			sounds.clear();
+			ids.clear();
+			bank.clear();
+		}
+
+		const Stats &stats() const noexcept { return lastStats; }
+		void resetStats() noexcept { lastStats = {}; }
+		int channels() const noexcept { return channelCount; }
+
+	private:
+		struct Sound {
+			Chunk chunk;
+			int priority {0};
+			int maxInstances {4};
+			float volume {1.0f};
+			int playing {0};
+			int pending {0};
+			float pendingVolume {0.0f};
+		};
+
+		struct Voice {
+			SoundId sound {invalid};
+			int priority {0};
+			uint32_t started {0};
+		};
+
+		// releases channels the mixer has finished with; polled rather than Mix_ChannelFinished, which runs on the audio thread
+		void refresh() {
+			for (int i = 0; i < channelCount; ++i) {
+				Voice &voice = voices[i];
+				if (voice.sound == invalid || Mix_Playing(i))
+					continue;
+
+				--sounds[voice.sound].playing;
+				voice = {};
+			}
+		}
+
+		// a free channel, or the oldest one playing something less important; -1 when there's neither
+		int claim(int priority) {
+			int victim = -1;
+			for (int i = 0; i < channelCount; ++i) {
+				const Voice &voice = voices[i];
+				if (voice.sound == invalid)
+					return i;
+
+				if (voice.priority >= priority)
+					continue;
+				if (victim < 0 || voice.priority < voices[victim].priority || (voice.priority == voices[victim].priority && voice.started < voices[victim].started))
+					victim = i;
+			}
+
+			if (victim >= 0) {
+				Mix_HaltChannel(victim);
+				--sounds[voices[victim].sound].playing;
+				voices[victim] = {};
+				++lastStats.stolen;
+			}
+			return victim;
+		}
+
+	private:
+		int channelCount;
+		std::vector<Voice> voices;
+		std::vector<Sound> sounds;
+		std::unordered_map<std::basic_string<char>, SoundId> ids;
+		std::unordered_map<std::basic_string<char>, Chunk> bank; // one decoded copy per file
+		std::vector<SoundId> queue;
+		uint32_t frame {0};
+		Stats lastStats;
+	};
+} // namespace gmtk
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Collects textured quads over a frame and submits them with one SDL_RenderGeometry call per texture run
+	 * Sprites are ordered by layer first; inside a layer they're grouped by texture (submission order is kept per texture)
+	 */
+	class SpriteBatch {
+	public:
+		struct Stats {
+			size_t sprites {0};
+			size_t drawCalls {0};
+		};
+
+		// same arguments as drawTexture so call sites can switch over one for one
+		void draw(SDL_Texture *tex, int x, int y, const SDL_Rect *clip = nullptr, double sx = 0.0, double sy = 0.0, int layer = 0) {
+			SDL_FRect dst = {static_cast<float>(x), static_cast<float>(y), 0.0f, 0.0f};
+			if (clip != nullptr) {
+				dst.w = static_cast<float>(clip->w);
+				dst.h = static_cast<float>(clip->h);
+			} else {
+				SDL_Point size = textureSize(tex);
+				dst.w = static_cast<float>(size.x);
+				dst.h = static_cast<float>(size.y);
+			}
+
+			if (sx != 0.0 && sy != 0.0) {
+				dst.w *= static_cast<float>(static_cast<int>(sx));
+				dst.h *= static_cast<float>(static_cast<int>(sy));
+			}
+
+			draw(tex, dst, clip, layer);
+		}
+
+		void draw(SDL_Texture *tex, const SDL_FRect &dst, const SDL_Rect *clip, int layer = 0, SDL_RendererFlip flip = SDL_FLIP_NONE, float angle = 0.0f, SDL_Color color = {255, 255, 255, 255}) {
+			if (tex == nullptr)
+				return;
+
+			Sprite sprite;
+			sprite.tex = tex;
+			sprite.layer = layer;
+			sprite.dst = dst;
+			sprite.src = clip != nullptr ? *clip : SDL_Rect {0, 0, 0, 0};
+			sprite.angle = angle;
+			sprite.flip = flip;
+			sprite.color = color;
+			sprite.order = static_cast<uint32_t>(sprites.size());
+			sprites.push_back(sprite);
+		}
+
+		void flush(SDL_Renderer *ren) {
+			lastStats = {sprites.size(), 0};
+
+			if (sprites.empty()) {
+				sizes.clear();
+				return;
+			}
+
+			// explicit order instead of stable_sort, which allocates a scratch buffer every call
+			auto less = [](const Sprite &a, const Sprite &b) {
+				if (a.layer != b.layer)
+					return a.layer < b.layer;
+				if (a.tex != b.tex)
+					return a.tex < b.tex;
+				return a.order < b.order;
+			};
+
+			// most frames submit runs that are already in order
+			if (!std::is_sorted(sprites.begin(), sprites.end(), less))
+				std::sort(sprites.begin(), sprites.end(), less);
+
+			size_t first = 0;
+			while (first < sprites.size()) {
+				size_t last = first;
+				while (last < sprites.size() && sprites[last].tex == sprites[first].tex && sprites[last].layer == sprites[first].layer)
+					++last;
+
+				submit(ren, first, last);
+				first = last;
+			}
+
+			sprites.clear();
+			// textures can be destroyed between frames so sizes are only trusted for one flush
+			sizes.clear();
+		}
+
+		const Stats &stats() const noexcept { return lastStats; }
+
+	private:
+		struct Sprite {
+			SDL_Texture *tex;
+			int layer;
+			SDL_FRect dst;
+			SDL_Rect src;
+			float angle;
+			SDL_RendererFlip flip;
+			SDL_Color color;
+			uint32_t order;
+		};
+
+		SDL_Point textureSize(SDL_Texture *tex) {
+			for (const auto &i : sizes) {
+				if (i.first == tex)
+					return i.second;
+			}
+
+			SDL_Point size = {0, 0};
+			SDL_QueryTexture(tex, nullptr, nullptr, &size.x, &size.y);
+			sizes.push_back({tex, size});
+			return size;
+		}
+
+		void submit(SDL_Renderer *ren, size_t first, size_t last) {
+			SDL_Texture *tex = sprites[first].tex;
+			SDL_Point size = textureSize(tex);
+			if (size.x <= 0 || size.y <= 0)
+				return;
+
+			const float invW = 1.0f / static_cast<float>(size.x);
+			const float invH = 1.0f / static_cast<float>(size.y);
+
+			const size_t quads = last - first;
+			vertices.resize(quads * 4);
+			// the index pattern never changes, so it only grows when a bigger run comes along
+			while (indices.size() < quads * 6) {
+				int base = static_cast<int>(indices.size() / 6) * 4;
+				const int quad[6] = {0, 1, 2, 0, 2, 3};
+				for (int q : quad)
+					indices.push_back(base + q);
+			}
+
+			SDL_Vertex *v = vertices.data();
+			for (size_t i = first; i < last; ++i, v += 4) {
+				const Sprite &s = sprites[i];
+
+				SDL_Rect src = s.src;
+				if (src.w == 0 || src.h == 0)
+					src = {0, 0, size.x, size.y};
+
+				float u0 = src.x * invW, v0 = src.y * invH;
+				float u1 = (src.x + src.w) * invW, v1 = (src.y + src.h) * invH;
+				if (s.flip & SDL_FLIP_HORIZONTAL)
+					std::swap(u0, u1);
+				if (s.flip & SDL_FLIP_VERTICAL)
+					std::swap(v0, v1);
+
+				// corners in clockwise order: top left, top right, bottom right, bottom left
+				SDL_FPoint corners[4] = {
+					{s.dst.x, s.dst.y},
+					{s.dst.x + s.dst.w, s.dst.y},
+					{s.dst.x + s.dst.w, s.dst.y + s.dst.h},
+					{s.dst.x, s.dst.y + s.dst.h},
+				};
+
+				if (s.angle != 0.0f) {
+					// same as SDL_RenderCopyEx: degrees, clockwise, around the center
+					float rad = s.angle * static_cast<float>(M_PI) / 180.0f;
+					float c = std::cos(rad), sn = std::sin(rad);
+					float cx = s.dst.x + s.dst.w * 0.5f, cy = s.dst.y + s.dst.h * 0.5f;
+					for (auto &p : corners) {
+						float dx = p.x - cx, dy = p.y - cy;
+						p = {cx + dx * c - dy * sn, cy + dx * sn + dy * c};
+					}
+				}
+
+				v[0] = {corners[0], s.color, {u0, v0}};
+				v[1] = {corners[1], s.color, {u1, v0}};
+				v[2] = {corners[2], s.color, {u1, v1}};
+				v[3] = {corners[3], s.color, {u0, v1}};
+			}
+
+			SDL_RenderGeometry(ren, tex, vertices.data(), static_cast<int>(quads * 4), indices.data(), static_cast<int>(quads * 6));
+			++lastStats.drawCalls;
+		}
+
+	private:
+		std::vector<Sprite> sprites;
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+		std::vector<std::pair<SDL_Texture *, SDL_Point>> sizes;
+		Stats lastStats;
+	};
+} // namespace gmtk
@@ -0,0 +1,749 @@
+// headless benchmarks, run with no gpu or display:
+// bench [frames]
+
+#include <SDL.h>
+#include "animation.hpp"
+#include "batch.hpp"
+#include "bullets.hpp"
+#include "camera.hpp"
+#include "collision.hpp"
+#include "components.hpp"
+#include "ecs.hpp"
+#include "flowfield.hpp"
+#include "helper.hpp"
+#include "jobs.hpp"
+#include "particles.hpp"
+#include "random.hpp"
+#include "shapes.hpp"
+#include "spatial.hpp"
+#include "tilemap.hpp"
+#include "vector2.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::atomic<size_t> allocations {0};
+
+// kept out of line so the optimizer can't see malloc/free behind new/delete and flag them as mismatched
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+BENCH_NOINLINE static void *countedAlloc(size_t size) noexcept {
+	++allocations;
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+BENCH_NOINLINE static void countedFree(void *p) noexcept { std::free(p); }
+
+void *operator new(size_t size) {
+	if (void *p = countedAlloc(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+	if (void *p = countedAlloc(size))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete[](void *p) noexcept { countedFree(p); }
+void operator delete(void *p, size_t) noexcept { countedFree(p); }
+void operator delete[](void *p, size_t) noexcept { countedFree(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { countedFree(p); }
+
+using namespace gmtk;
+
+namespace lightning {
+	SDL_Surface *canvas;
+	SDL_Renderer *strike;
+	std::mt19937 gen(1234); // fixed seed so runs are comparable
+	int w {1280}, h {720};
+}
+
+struct Result {
+	double nsPerFrame;
+	double allocsPerFrame;
+	double drawCallsPerFrame;
+};
+
+// frame() returns the number of draw calls it issued
+static Result measure(int frames, const std::function<size_t()> &frame) {
+	// one warm up frame so lazy setup (texture sizes, buffer growth) isn't counted
+	frame();
+
+	size_t drawCalls = 0;
+	size_t allocsBefore = allocations.load();
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < frames; ++i)
+		drawCalls += frame();
+
+	auto end = std::chrono::steady_clock::now();
+	size_t allocs = allocations.load() - allocsBefore;
+
+	return {
+		std::chrono::duration<double, std::nano>(end - start).count() / frames,
+		static_cast<double>(allocs) / frames,
+		static_cast<double>(drawCalls) / frames,
+	};
+}
+
+static void report(const char *name, int n, const Result &r) {
+	std::printf("%-28s %7d %14.0f %10.2f %10.1f\n", name, n, r.nsPerFrame, r.allocsPerFrame, r.drawCallsPerFrame);
+}
+
+// solid colored stand-in so the benchmark doesn't depend on the assets folder
+static Texture makeTexture(int w, int h, uint8_t r, uint8_t g, uint8_t b) {
+	SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_FillRect(surf, nullptr, SDL_MapRGBA(surf->format, r, g, b, 255));
+	auto tex = Texture(SDL_CreateTextureFromSurface(lightning::strike, surf), SDL_DestroyTexture);
+	SDL_FreeSurface(surf);
+	return tex;
+}
+
+static void clear() {
+	SDL_SetRenderDrawColor(lightning::strike, 0, 0, 0, 255);
+	SDL_RenderClear(lightning::strike);
+}
+
+static std::vector<SDL_FRect> randomBoxes(int n, float size) {
+	std::uniform_real_distribution<float> x(0.0f, lightning::w - size), y(0.0f, lightning::h - size);
+	std::vector<SDL_FRect> boxes(n);
+	for (auto &box : boxes)
+		box = {x(lightning::gen), y(lightning::gen), size, size};
+	return boxes;
+}
+
+static void benchWalls(int n, int frames) {
+	auto wall = makeTexture(32, 32, 120, 80, 40);
+	auto boxes = randomBoxes(n, 32.0f);
+
+	report("walls drawTexture", n, measure(frames, [&] {
+		clear();
+		for (const auto &box : boxes)
+			drawTexture(wall.get(), lightning::strike, (int)box.x, (int)box.y);
+		return boxes.size();
+	}));
+
+	SpriteBatch batch;
+	report("walls SpriteBatch", n, measure(frames, [&] {
+		clear();
+		for (const auto &box : boxes)
+			batch.draw(wall.get(), (int)box.x, (int)box.y);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+
+	TileMap map(lightning::w / 32, lightning::h / 32, 32);
+	map.setTileType(1, wall);
+	for (const auto &box : boxes)
+		map.set((int)box.x / 32, (int)box.y / 32, 1);
+
+	report("walls TileMap", n, measure(frames, [&] {
+		clear();
+		map.draw(lightning::strike);
+		return static_cast<size_t>(map.chunkCount());
+	}));
+}
+
+static void benchBullets(int n, int frames) {
+	auto particle = makeTexture(8, 8, 255, 255, 255);
+	BulletPool pool(n, 8.0f, 8.0f);
+	SpriteBatch batch;
+	const SDL_FRect arena = {0, 0, (float)lightning::w, (float)lightning::h};
+	std::uniform_real_distribution<float> x(0.0f, (float)lightning::w), y(0.0f, (float)lightning::h);
+
+	report("bullets update+draw", n, measure(frames, [&] {
+		// keep the pool full, dead bullets get replaced every frame
+		while (pool.size() < pool.capacity())
+			pool.spawn(vec2f(x(lightning::gen), y(lightning::gen)), vec2f(x(lightning::gen), y(lightning::gen)), 0.2f, 2000.0f);
+
+		clear();
+		pool.update(1000.0f / 120.0f, arena);
+		pool.draw(batch, particle.get());
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+}
+
+static void benchSprites(int n, int frames) {
+	// 7 frame 32x27 strip, same layout as the ladybug attack clip
+	auto sheet = makeTexture(32 * 7, 27, 200, 40, 40);
+	auto boxes = randomBoxes(n, 32.0f);
+	auto set = std::make_shared<AnimationSet>(sheet);
+	ClipId attack = set->addClip("Attack", 7, 0, 0, 32, 27, 100.0f);
+
+	std::vector<Animation> anims(n, Animation(set));
+	for (auto &anim : anims)
+		anim.play(attack);
+
+	SpriteBatch batch;
+
+	report("animated sprites", n, measure(frames, [&] {
+		clear();
+		for (int i = 0; i < n; ++i) {
+			anims[i].update(1000.0f / 120.0f);
+			anims[i].draw(batch, (int)boxes[i].x, (int)boxes[i].y);
+		}
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+}
+
+// what drawCircle used to do: a 75 triangle fan rebuilt with sin / cos on every call
+static void legacyCircle(SDL_Renderer *ren, float x, float y, float radius) {
+	constexpr int tris = 225;
+	const float mirror = 2.0f * static_cast<float>(M_PI);
+	SDL_Vertex vertices[tris] = {};
+
+	for (int i = 0; i < tris; i += 3) {
+		vertices[i].position = {x, y};
+		vertices[i].color = {255, 255, 255, 255};
+		vertices[i + 1].position = {x + std::cos(i * mirror / (tris - 3)) * radius, y + std::sin(i * mirror / (tris - 3)) * radius};
+		vertices[i + 1].color = {255, 255, 255, 255};
+		if (i > 0) {
+			vertices[i - 1].position = {x + std::cos(i * mirror / (tris - 3)) * radius, y + std::sin(i * mirror / (tris - 3)) * radius};
+			vertices[i - 1].color = {255, 255, 255, 255};
+		}
+	}
+
+	SDL_RenderGeometry(ren, nullptr, vertices, tris - 3, nullptr, tris - 3);
+}
+
+// a pool held at about n live particles by emitters spread over the screen
+static void benchParticles(int n, int frames) {
+	auto tex = makeTexture(8, 8, 255, 200, 80);
+	const float dt = 1000.0f / 120.0f;
+
+	ParticleEffect fx;
+	fx.tex = tex.get();
+	fx.lifeMin = 400.0f;
+	fx.lifeMax = 800.0f;
+	fx.gravityY = 0.0004f;
+	fx.sizeStart = 6.0f;
+	fx.sizeEnd = 1.0f;
+	ParticlePool pool(fx, n, 1234);
+
+	// 16 emitters, together spawning what dies each tick on average
+	auto spots = randomBoxes(16, 0.0f);
+	std::vector<ParticleEmitter> emitters(spots.size());
+	for (size_t i = 0; i < emitters.size(); ++i) {
+		emitters[i].position = vec2f(spots[i].x, spots[i].y);
+		emitters[i].rate = n / 0.6f / emitters.size();
+		emitters[i].burst = n / emitters.size();
+	}
+
+	report("particles update", n, measure(frames, [&] {
+		for (auto &e : emitters)
+			e.update(pool, dt);
+		pool.update(dt);
+		return size_t {0};
+	}));
+
+	report("particles update+draw", n, measure(frames, [&] {
+		clear();
+		for (auto &e : emitters)
+			e.update(pool, dt);
+		pool.update(dt);
+		pool.draw(lightning::strike);
+		return size_t {1};
+	}));
+}
+
+// glows and small flashes, the sizes a fight throws around
+static void benchShapes(int n, int frames) {
+	auto boxes = randomBoxes(n, 0.0f);
+	std::uniform_real_distribution<float> size(2.0f, 48.0f);
+	std::vector<float> radii(n);
+	for (auto &r : radii)
+		r = size(lightning::gen);
+
+	report("circles rebuilt per call", n, measure(frames, [&] {
+		clear();
+		for (int i = 0; i < n; ++i)
+			legacyCircle(lightning::strike, boxes[i].x, boxes[i].y, radii[i]);
+		return static_cast<size_t>(n);
+	}));
+
+	report("circles drawCircle", n, measure(frames, [&] {
+		clear();
+		for (int i = 0; i < n; ++i)
+			drawCircle(lightning::strike, boxes[i].x, boxes[i].y, radii[i]);
+		return static_cast<size_t>(n);
+	}));
+
+	ShapeBatch shapes;
+	report("circles ShapeBatch", n, measure(frames, [&] {
+		clear();
+		for (int i = 0; i < n; ++i)
+			shapes.circle(boxes[i].x, boxes[i].y, radii[i], {255, 255, 255, 255});
+		shapes.flush(lightning::strike);
+		return shapes.stats().drawCalls;
+	}));
+}
+
+// the shape enemies had before the ecs: one heap object each, reached through a vtable
+struct VirtualEnemy {
+	virtual ~VirtualEnemy() = default;
+	virtual void update(float dt) = 0;
+	virtual void draw(SpriteBatch &batch) = 0;
+};
+
+struct VirtualWasp final : VirtualEnemy {
+	VirtualWasp(std::shared_ptr<const AnimationSet> set, ClipId clip, float x, float y) : anim(std::move(set)), x(x), y(y) { anim.play(clip); }
+
+	void update(float dt) override {
+		x += vx * dt;
+		y += vy * dt;
+		anim.update(dt);
+	}
+
+	void draw(SpriteBatch &batch) override { anim.draw(batch, (int)x, (int)y); }
+
+	std::basic_string<char> name {"wasp"};
+	Animation anim;
+	float x, y;
+	float vx {0.01f}, vy {0.01f};
+	int hp {15};
+};
+
+static void benchEnemies(int n, int frames) {
+	auto sheet = makeTexture(32 * 7, 27, 40, 200, 40);
+	auto boxes = randomBoxes(n, 32.0f);
+	auto set = std::make_shared<AnimationSet>(sheet, 1.0);
+	ClipId fly = set->addClip("Fly", 7, 0, 0, 32, 27, 100.0f);
+	const float dt = 1000.0f / 120.0f;
+	SpriteBatch batch;
+
+	std::vector<std::unique_ptr<VirtualEnemy>> enemies;
+	for (int i = 0; i < n; ++i)
+		enemies.push_back(std::make_unique<VirtualWasp>(set, fly, boxes[i].x, boxes[i].y));
+
+	report("enemies virtual", n, measure(frames, [&] {
+		clear();
+		for (auto &enemy : enemies)
+			enemy->update(dt);
+		for (auto &enemy : enemies)
+			enemy->draw(batch);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+
+	Registry reg;
+	for (int i = 0; i < n; ++i) {
+		Entity e = reg.create();
+		reg.emplace<Transform>(e, boxes[i].x, boxes[i].y, boxes[i].x, boxes[i].y);
+		reg.emplace<Velocity>(e, 0.01f, 0.01f);
+		reg.emplace<Health>(e, 15, 15);
+		reg.emplace<AnimationState>(e, fly);
+		reg.emplace<Sprite>(e, sheet, set->frame(fly, 0), set.get());
+	}
+
+	report("enemies ecs", n, measure(frames, [&] {
+		clear();
+		storePrevious(reg);
+		integrate(reg, dt);
+		animate(reg, dt);
+		drawSprites(reg, batch);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+}
+
+static void benchDice(int n, int frames) {
+	if (fontCache().get("assets/Onest.ttf", 48) == nullptr) {
+		std::printf("%-28s %7d   skipped (assets/Onest.ttf not found)\n", "dice labels", n);
+		return;
+	}
+
+	std::uniform_int_distribution<int> roll(0, 50);
+	std::vector<int> values(n);
+	for (auto &v : values)
+		v = roll(lightning::gen);
+
+	auto boxes = randomBoxes(n, 48.0f);
+	TextCache labels {64};
+
+	report("dice labels TextCache", n, measure(frames, [&] {
+		clear();
+		for (int i = 0; i < n; ++i) {
+			auto tex = labels.get(std::to_string(values[i]), lightning::strike, "assets/Onest.ttf", {0, 0, 0, 255}, 48, true);
+			drawTexture(tex.get(), lightning::strike, (int)boxes[i].x, (int)boxes[i].y);
+		}
+		return static_cast<size_t>(n);
+	}));
+
+	GlyphAtlas digits;
+	digits.build(lightning::strike, "assets/Onest.ttf", {0, 0, 0, 255}, 48, true);
+
+	report("dice labels GlyphAtlas", n, measure(frames, [&] {
+		clear();
+		size_t calls = 0;
+		for (int i = 0; i < n; ++i) {
+			auto label = std::to_string(values[i]);
+			digits.draw(lightning::strike, label, (int)boxes[i].x, (int)boxes[i].y);
+			calls += label.size();
+		}
+		return calls;
+	}));
+}
+
+// n damage rolls a frame: std distribution over mt19937 vs Rng one at a time vs Rng::rollN
+static void benchRolls(int n, int frames) {
+	std::vector<int> out(n);
+	std::mt19937_64 mt(1234);
+	std::uniform_int_distribution<int> d20(1, 20);
+	Rng rng(1234);
+	// keeps the rolls from being optimised away
+	volatile int sink = 0;
+
+	report("rolls mt19937_64", n, measure(frames, [&] {
+		for (auto &v : out)
+			v = d20(mt);
+		sink = out[n - 1];
+		return size_t {0};
+	}));
+
+	report("rolls Rng::range", n, measure(frames, [&] {
+		for (auto &v : out)
+			v = rng.range(1, 20);
+		sink = out[n - 1];
+		return size_t {0};
+	}));
+
+	report("rolls Rng::rollN", n, measure(frames, [&] {
+		rng.rollN(1, 20, out.size(), out.data());
+		sink = out[n - 1];
+		return size_t {0};
+	}));
+}
+
+static void benchCollision(int n, int frames) {
+	auto boxes = randomBoxes(n, 16.0f);
+	std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+	size_t hits = 0;
+
+	report("collision all pairs", n, measure(frames, [&] {
+		for (int i = 0; i < n; ++i) {
+			for (int j = i + 1; j < n; ++j) {
+				if (SDL_HasIntersectionF(&boxes[i], &boxes[j]))
+					++hits;
+			}
+		}
+		return size_t {0};
+	}));
+
+	SpatialGrid grid(32.0f);
+	std::vector<SpatialGrid::Proxy> proxies(n);
+	for (int i = 0; i < n; ++i)
+		proxies[i] = grid.insert(boxes[i], i);
+
+	report("collision SpatialGrid", n, measure(frames, [&] {
+		for (int i = 0; i < n; ++i) {
+			boxes[i].x += step(lightning::gen);
+			boxes[i].y += step(lightning::gen);
+			grid.move(proxies[i], boxes[i]);
+		}
+
+		for (int i = 0; i < n; ++i) {
+			grid.query(boxes[i], [&](SpatialGrid::Proxy id) {
+				if (id != proxies[i])
+					++hits;
+			});
+		}
+		return size_t {0};
+	}));
+
+	// keeps the optimizer from dropping the loops
+	if (hits == SIZE_MAX)
+		std::printf("%zu\n", hits);
+}
+
+static void benchPathing(int n, int frames) {
+	// 4x the screen in 32px cells with a fifth of them walled off
+	const int cols = lightning::w / 8, rows = lightning::h / 8;
+	FlowField field(cols, rows, 32.0f);
+	std::uniform_int_distribution<int> wall(0, 4);
+	for (int row = 0; row < rows; ++row) {
+		for (int col = 0; col < cols; ++col)
+			field.setSolid(col, row, wall(lightning::gen) == 0);
+	}
+
+	Registry reg;
+	std::uniform_real_distribution<float> x(0.0f, cols * 32.0f), y(0.0f, rows * 32.0f);
+	for (int i = 0; i < n; ++i) {
+		Entity e = reg.create();
+		float px = x(lightning::gen), py = y(lightning::gen);
+		reg.emplace<Transform>(e, px, py, px, py);
+		reg.emplace<Velocity>(e);
+		reg.emplace<Pursuer>(e, 0.2f);
+	}
+
+	// the target walks one cell per frame, so every frame pays for a full rebuild
+	int frame = 0;
+	report("flow field rebuild+follow", n, measure(frames, [&] {
+		vec2f target(16.0f + 32.0f * (frame++ % cols), rows * 16.0f);
+		field.update(target);
+		followField(reg, field, target);
+		integrate(reg, 1000.0f / 120.0f);
+		return size_t {0};
+	}));
+
+	vec2f still(cols * 16.0f, rows * 16.0f);
+	report("flow field follow", n, measure(frames, [&] {
+		field.update(still);
+		followField(reg, field, still);
+		integrate(reg, 1000.0f / 120.0f);
+		return size_t {0};
+	}));
+}
+
+static void benchMovers(int n, int frames) {
+	// screen sized room with a border and scattered pillars
+	const int tile = 32, cols = lightning::w / tile, rows = lightning::h / tile;
+	TileMap map(cols, rows, tile);
+	map.setTileType(1, nullptr);
+	std::uniform_int_distribution<int> pillar(0, 9);
+	for (int row = 0; row < rows; ++row) {
+		for (int col = 0; col < cols; ++col) {
+			bool border = row == 0 || col == 0 || row == rows - 1 || col == cols - 1;
+			if (border || pillar(lightning::gen) == 0)
+				map.set(col, row, 1);
+		}
+	}
+
+	Registry reg;
+	SpatialGrid grid(32.0f);
+	std::uniform_real_distribution<float> x(tile, (cols - 1) * tile - 8.0f), y(tile, (rows - 1) * tile - 8.0f);
+	std::uniform_real_distribution<float> speed(-0.5f, 0.5f);
+	for (int i = 0; i < n; ++i) {
+		Entity e = reg.create();
+		float px = x(lightning::gen), py = y(lightning::gen);
+		reg.emplace<Transform>(e, px, py, px, py);
+		reg.emplace<Velocity>(e, speed(lightning::gen), speed(lightning::gen));
+		reg.emplace<Collider>(e, 0.0f, 0.0f, 8.0f, 8.0f);
+	}
+	syncColliders(reg, grid);
+
+	// walls zero velocity, give the stopped ones a new heading so every frame has real work
+	auto kick = [&] {
+		reg.pool<Velocity>().each([&](Entity, Velocity &v) {
+			if (v.x == 0.0f)
+				v.x = speed(lightning::gen);
+			if (v.y == 0.0f)
+				v.y = speed(lightning::gen);
+		});
+	};
+
+	report("movers vs tiles", n, measure(frames, [&] {
+		kick();
+		resolveMovers(reg, map, nullptr, 1000.0f / 120.0f);
+		return size_t {0};
+	}));
+
+	report("movers vs tiles+movers", n, measure(frames, [&] {
+		kick();
+		resolveMovers(reg, map, &grid, 1000.0f / 120.0f);
+		return size_t {0};
+	}));
+}
+
+// sprites spread over a world 8x8 screens big, everything drawn vs only what the camera sees
+static void benchCamera(int n, int frames) {
+	auto sheet = makeTexture(32, 27, 200, 200, 40);
+	const float worldW = lightning::w * 8.0f, worldH = lightning::h * 8.0f;
+
+	const int tile = 32;
+	TileMap map(static_cast<int>(worldW) / tile, static_cast<int>(worldH) / tile, tile);
+	map.setTileType(1, makeTexture(tile, tile, 90, 90, 90));
+	for (int row = 0; row < map.rows(); row += 3) {
+		for (int col = row % 7; col < map.columns(); col += 7)
+			map.set(col, row, 1);
+	}
+
+	Registry reg;
+	SpatialGrid grid(64.0f);
+	std::uniform_real_distribution<float> x(0.0f, worldW - 32.0f), y(0.0f, worldH - 27.0f);
+	for (int i = 0; i < n; ++i) {
+		Entity e = reg.create();
+		float px = x(lightning::gen), py = y(lightning::gen);
+		reg.emplace<Transform>(e, px, py, px, py);
+		reg.emplace<Collider>(e, 0.0f, 0.0f, 32.0f, 27.0f);
+		Sprite &s = reg.emplace<Sprite>(e);
+		s.tex = sheet;
+	}
+	syncColliders(reg, grid);
+
+	Camera2D cam(static_cast<float>(lightning::w), static_cast<float>(lightning::h));
+	cam.setBounds({0.0f, 0.0f, worldW, worldH});
+	cam.lookAt(vec2f(worldW * 0.5f, worldH * 0.5f));
+
+	SpriteBatch batch;
+
+	report("world draw all", n, measure(frames, [&] {
+		clear();
+		map.draw(lightning::strike, 0, 0);
+		drawSprites(reg, batch);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+
+	report("world draw camera", n, measure(frames, [&] {
+		clear();
+		map.draw(lightning::strike, cam);
+		drawSprites(reg, batch, cam);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+
+	report("world draw camera+grid", n, measure(frames, [&] {
+		clear();
+		map.draw(lightning::strike, cam);
+		drawSprites(reg, batch, cam, grid);
+		batch.flush(lightning::strike);
+		return batch.stats().drawCalls;
+	}));
+}
+
+// the same frame of systems on 1..N threads, n is the entity count
+static void benchJobs(int n, int frames) {
+	auto sheet = makeTexture(32 * 7, 27, 40, 40, 200);
+	auto set = std::make_shared<AnimationSet>(sheet, 1.0);
+	ClipId fly = set->addClip("Fly", 7, 0, 0, 32, 27, 100.0f);
+	auto boxes = randomBoxes(n, 8.0f);
+	const float dt = 1000.0f / 120.0f;
+
+	// open screen sized room, everyone chases the middle and shoves past each other on the way
+	const int tile = 32, cols = lightning::w / tile, rows = lightning::h / tile;
+	TileMap map(cols, rows, tile);
+	FlowField field(cols, rows, static_cast<float>(tile));
+	vec2f target(lightning::w * 0.5f, lightning::h * 0.5f);
+
+	Registry reg;
+	for (int i = 0; i < n; ++i) {
+		Entity e = reg.create();
+		reg.emplace<Transform>(e, boxes[i].x, boxes[i].y);
+		reg.emplace<Velocity>(e);
+		reg.emplace<Pursuer>(e, 0.05f);
+		reg.emplace<Collider>(e, 0.0f, 0.0f, 8.0f, 8.0f);
+		reg.emplace<AnimationState>(e, fly);
+		reg.emplace<Sprite>(e, sheet, set->frame(fly, 0), set.get());
+	}
+
+	SpatialGrid grid(32.0f);
+	syncColliders(reg, grid);
+	std::vector<SDL_FRect> moved;
+
+	// powers of two up to the core count, and the core count itself
+	int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	std::vector<int> counts;
+	for (int threads = 1; threads < maxThreads; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(maxThreads);
+
+	for (int threads : counts) {
+		JobSystem jobs(threads - 1);
+		char name[32];
+		SDL_snprintf(name, sizeof(name), "jobs %d thread%s", threads, threads > 1 ? "s" : "");
+
+		report(name, n, measure(frames, [&] {
+			field.update(target);
+			followField(reg, field, target, jobs);
+			resolveMovers(reg, map, &grid, dt, jobs, moved);
+			animate(reg, dt, jobs);
+			return size_t {0};
+		}));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+
+	// no display needed, but let an explicit SDL_VIDEODRIVER win
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+	// not SDL_assert, that compiles out at the release assert level these are built with
+	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+		std::printf("SDL failed to initialize: %s\n", SDL_GetError());
+		return 1;
+	}
+	if (IMG_Init(IMG_INIT_PNG) == 0) {
+		std::printf("SDL_image failed to initialize: %s\n", IMG_GetError());
+		return 1;
+	}
+	if (TTF_Init() == -1) return 1;
+
+	lightning::canvas = SDL_CreateRGBSurfaceWithFormat(0, lightning::w, lightning::h, 32, SDL_PIXELFORMAT_ARGB8888);
+	lightning::strike = SDL_CreateSoftwareRenderer(lightning::canvas);
+	if (lightning::strike == nullptr) {
+		std::printf("Software renderer failed to be created: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	std::printf("%d frames per scenario, software renderer %dx%d\n\n", frames, lightning::w, lightning::h);
+	std::printf("%-28s %7s %14s %10s %10s\n", "scenario", "n", "ns/frame", "allocs", "draws");
+
+	for (int n : {110, 1000, 10000})
+		benchWalls(n, frames);
+
+	for (int n : {1000, 10000, 50000})
+		benchBullets(n, frames);
+
+	for (int n : {1000, 10000})
+		benchSprites(n, frames);
+
+	for (int n : {1000, 10000})
+		benchShapes(n, frames);
+
+	for (int n : {10000, 50000, 100000})
+		benchParticles(n, frames);
+
+	for (int n : {1000, 10000})
+		benchEnemies(n, frames);
+
+	for (int n : {100, 1000})
+		benchDice(n, frames);
+
+	for (int n : {1000, 100000})
+		benchRolls(n, frames);
+
+	for (int n : {1000, 5000})
+		benchCollision(n, frames);
+
+	for (int n : {1000, 10000})
+		benchPathing(n, frames);
+
+	for (int n : {1000, 10000, 50000})
+		benchMovers(n, frames);
+
+	for (int n : {1000, 10000, 50000})
+		benchCamera(n, frames);
+
+	for (int n : {10000, 100000})
+		benchJobs(n, frames);
+
+	fontCache().clear();
+	SDL_DestroyRenderer(lightning::strike);
+	SDL_FreeSurface(lightning::canvas);
+	SDL_Quit();
+
+	return 0;
+}
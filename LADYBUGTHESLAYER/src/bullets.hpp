@@ -0,0 +1,206 @@
+#pragma once
+
+#include <SDL.h>
+#include "batch.hpp"
+#include "vector2.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GMTK_BULLETS_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GMTK_BULLETS_SSE 1
+#endif
+
+namespace gmtk {
+	/**
+	 * Fixed capacity projectile storage, one contiguous array per field
+	 * Dead slots go back on a free list so spawning never touches the heap after construction
+	 * All bullets in a pool share one sprite, so the box size is stored once
+	 */
+	class BulletPool {
+	public:
+		static constexpr uint32_t invalid = UINT32_MAX;
+
+		BulletPool(size_t capacity, float width, float height) : cap(capacity), width(width), height(height) {
+			// pad to a multiple of 8 so the simd loop never needs a remainder
+			size_t padded = (capacity + 7) & ~static_cast<size_t>(7);
+			x.assign(padded, 0.0f);
+			y.assign(padded, 0.0f);
+			vx.assign(padded, 0.0f);
+			vy.assign(padded, 0.0f);
+			life.assign(padded, 0.0f);
+
+			freeList.reserve(capacity);
+			for (size_t i = capacity; i > 0; --i)
+				freeList.push_back(static_cast<uint32_t>(i - 1));
+		}
+
+		// speed is in pixels per millisecond, lifetime in milliseconds
+		uint32_t spawn(vec2f pos, vec2f target, float speed, float lifetime) {
+			if (freeList.empty() || lifetime <= 0.0f)
+				return invalid;
+
+			uint32_t slot = freeList.back();
+			freeList.pop_back();
+
+			float dx = target.x - pos.x, dy = target.y - pos.y;
+			float len = std::sqrt(dx * dx + dy * dy);
+			if (len > 0.0f) {
+				dx /= len;
+				dy /= len;
+			} else {
+				dx = 1.0f;
+				dy = 0.0f;
+			}
+
+			x[slot] = pos.x;
+			y[slot] = pos.y;
+			vx[slot] = dx * speed;
+			vy[slot] = dy * speed;
+			life[slot] = lifetime;
+
+			if (slot >= highWater)
+				highWater = slot + 1;
+			++liveCount;
+
+			return slot;
+		}
+
+		void kill(uint32_t slot) {
+			if (slot >= cap || life[slot] <= 0.0f)
+				return;
+
+			life[slot] = 0.0f;
+			freeList.push_back(slot);
+			--liveCount;
+		}
+
+		// moves every bullet and retires the ones that ran out of time or left bounds
+		void update(float dt, const SDL_FRect &bounds) {
+			size_t count = (highWater + 7) & ~static_cast<size_t>(7);
+			const float minX = bounds.x - width, minY = bounds.y - height;
+			const float maxX = bounds.x + bounds.w, maxY = bounds.y + bounds.h;
+
+			size_t i = 0;
+#if defined(GMTK_BULLETS_AVX)
+			const __m256 vdt = _mm256_set1_ps(dt), zero = _mm256_setzero_ps();
+			const __m256 vminX = _mm256_set1_ps(minX), vminY = _mm256_set1_ps(minY);
+			const __m256 vmaxX = _mm256_set1_ps(maxX), vmaxY = _mm256_set1_ps(maxY);
+			for (; i < count; i += 8) {
+				__m256 l = _mm256_loadu_ps(&life[i]);
+				__m256 wasAlive = _mm256_cmp_ps(l, zero, _CMP_GT_OQ);
+				if (_mm256_movemask_ps(wasAlive) == 0)
+					continue;
+
+				__m256 px = _mm256_add_ps(_mm256_loadu_ps(&x[i]), _mm256_mul_ps(_mm256_loadu_ps(&vx[i]), vdt));
+				__m256 py = _mm256_add_ps(_mm256_loadu_ps(&y[i]), _mm256_mul_ps(_mm256_loadu_ps(&vy[i]), vdt));
+				l = _mm256_sub_ps(l, vdt);
+
+				__m256 keep = _mm256_and_ps(_mm256_cmp_ps(l, zero, _CMP_GT_OQ), _mm256_and_ps(
+					_mm256_and_ps(_mm256_cmp_ps(px, vminX, _CMP_GT_OQ), _mm256_cmp_ps(px, vmaxX, _CMP_LT_OQ)),
+					_mm256_and_ps(_mm256_cmp_ps(py, vminY, _CMP_GT_OQ), _mm256_cmp_ps(py, vmaxY, _CMP_LT_OQ))));
+
+				_mm256_storeu_ps(&x[i], px);
+				_mm256_storeu_ps(&y[i], py);
+				// dead lanes are pinned to zero so they never come back to life
+				_mm256_storeu_ps(&life[i], _mm256_and_ps(l, keep));
+
+				retire(i, _mm256_movemask_ps(_mm256_andnot_ps(keep, wasAlive)));
+			}
+#elif defined(GMTK_BULLETS_SSE)
+			const __m128 vdt = _mm_set1_ps(dt), zero = _mm_setzero_ps();
+			const __m128 vminX = _mm_set1_ps(minX), vminY = _mm_set1_ps(minY);
+			const __m128 vmaxX = _mm_set1_ps(maxX), vmaxY = _mm_set1_ps(maxY);
+			for (; i < count; i += 4) {
+				__m128 l = _mm_loadu_ps(&life[i]);
+				__m128 wasAlive = _mm_cmpgt_ps(l, zero);
+				if (_mm_movemask_ps(wasAlive) == 0)
+					continue;
+
+				__m128 px = _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(_mm_loadu_ps(&vx[i]), vdt));
+				__m128 py = _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(_mm_loadu_ps(&vy[i]), vdt));
+				l = _mm_sub_ps(l, vdt);
+
+				__m128 keep = _mm_and_ps(_mm_cmpgt_ps(l, zero), _mm_and_ps(
+					_mm_and_ps(_mm_cmpgt_ps(px, vminX), _mm_cmplt_ps(px, vmaxX)),
+					_mm_and_ps(_mm_cmpgt_ps(py, vminY), _mm_cmplt_ps(py, vmaxY))));
+
+				_mm_storeu_ps(&x[i], px);
+				_mm_storeu_ps(&y[i], py);
+				// dead lanes are pinned to zero so they never come back to life
+				_mm_storeu_ps(&life[i], _mm_and_ps(l, keep));
+
+				retire(i, _mm_movemask_ps(_mm_andnot_ps(keep, wasAlive)));
+			}
+#endif
+			for (; i < count; ++i) {
+				if (life[i] <= 0.0f)
+					continue;
+
+				x[i] += vx[i] * dt;
+				y[i] += vy[i] * dt;
+				life[i] -= dt;
+
+				bool keep = life[i] > 0.0f && x[i] > minX && x[i] < maxX && y[i] > minY && y[i] < maxY;
+				if (!keep) {
+					life[i] = 0.0f;
+					retire(i, 1);
+				}
+			}
+
+			// shrink the scanned range once the tail of the pool has emptied out
+			while (highWater > 0 && life[highWater - 1] <= 0.0f)
+				--highWater;
+		}
+
+		void draw(SpriteBatch &batch, SDL_Texture *tex, int layer = 0) const {
+			for (size_t i = 0; i < highWater; ++i) {
+				if (life[i] > 0.0f)
+					batch.draw(tex, {x[i], y[i], width, height}, nullptr, layer);
+			}
+		}
+
+		bool alive(uint32_t slot) const noexcept { return slot < cap && life[slot] > 0.0f; }
+		SDL_FRect box(uint32_t slot) const noexcept { return {x[slot], y[slot], width, height}; }
+		vec2f position(uint32_t slot) const noexcept { return vec2f(x[slot], y[slot]); }
+
+		size_t size() const noexcept { return liveCount; }
+		size_t capacity() const noexcept { return cap; }
+
+		// calls fn(slot) for every live bullet
+		template <typename F>
+		void forEach(F &&fn) const {
+			for (size_t i = 0; i < highWater; ++i) {
+				if (life[i] > 0.0f)
+					fn(static_cast<uint32_t>(i));
+			}
+		}
+
+	private:
+		void retire(size_t first, int mask) {
+			while (mask != 0) {
+				int lane = 0;
+				while (!(mask & (1 << lane)))
+					++lane;
+				mask &= ~(1 << lane);
+
+				freeList.push_back(static_cast<uint32_t>(first + lane));
+				--liveCount;
+			}
+		}
+
+	private:
+		size_t cap;
+		float width, height;
+		std::vector<float> x, y;
+		std::vector<float> vx, vy;
+		std::vector<float> life;
+		std::vector<uint32_t> freeList;
+		size_t highWater {0};
+		size_t liveCount {0};
+	};
+} // namespace gmtk
@@ -1,5 +1,10 @@
 #include <SDL.h>
+#include "camera.hpp"
+#include "collision.hpp"
+#include "gameloop.hpp"
 #include "helper.hpp"
+#include "input.hpp"
+#include "tilemap.hpp"
 #include "vector2.hpp"
 #include <iostream>
 #include <memory>
@@ -17,27 +22,10 @@ using RNDRPTR = std::unique_ptr<SDL_Renderer, Memory>;
 
 namespace lightning {
 	RNDRPTR strike;
+	TextureCache textures;
 	uint32_t w {1280}, h {720};
 }
 
-struct Wall {
-	Wall() {
-		wallTex = loadTexture("assets/rock.png", lightning::strike.get());
-	}
-
-	void draw() {
-		drawTexture(wallTex.get(), lightning::strike.get(), pos.x, pos.y);
-	}
-
-	//void update() {
-
-	//}
-
-	Texture wallTex;
-	vec2f pos;
-	SDL_FRect box;
-};
-
 int main(int, char **)
 {
 	SDL_assert(SDL_Init(SDL_INIT_EVERYTHING) == 0);
@@ -46,148 +34,102 @@ int main(int, char **)
 
 	auto window = WNDPTR(SDL_CreateWindow("", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, screenW, screenH, 0));
 	lightning::strike = RNDRPTR(SDL_CreateRenderer(window.get(), -1, SDL_RENDERER_ACCELERATED));
-	auto target = SDL_CreateTexture(lightning::strike.get(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, screenW, screenH);
 
 	Texture map = loadTexture("assets/map.png", lightning::strike.get());
 
-	SDL_Rect makeTextureBig = {0, 0, screenW, screenH};
-	SDL_FRect pp = {screenW / 2, screenH / 2, 35, 40};
+	// the world is several screens across, only what the camera sees gets drawn
+	int tileSize = 32;
+	int worldW = screenW * 4, worldH = screenH * 4;
+	SDL_FRect pp = {worldW / 2.0f, worldH / 2.0f, 35, 40};
 	vec2f lastPos;
-	vec2f ppPos = vec2f(screenW / 2, screenH / 2);
+	vec2f ppPos = vec2f(pp.x, pp.y);
 
-	std::vector<std::unique_ptr<Wall>> walls;
-	int tileSize = 32;
+	TileMap walls(worldW / tileSize, worldH / tileSize, tileSize, 16);
+	walls.setTileType(1, lightning::textures.load("assets/rock.png", lightning::strike.get()));
+
+	for (int i = 0; i < walls.columns(); i++) {
+		walls.set(i, 0, 1); // top row
+		walls.set(i, walls.rows() - 1, 1); // bottom row
+	}
 
-	for (int i = 0; i < screenW / tileSize; i++) {
-		// top row
-		auto nwt = std::make_unique<Wall>();
-		nwt->pos = vec2f(i * tileSize, 0);
-		nwt->box = {nwt->pos.x, nwt->pos.y, (float)tileSize, (float)tileSize};
-		walls.push_back(std::move(nwt));
-
-		// bottom row
-		auto nwb = std::make_unique<Wall>();
-		nwb->pos = vec2f(i * tileSize, screenH - tileSize);
-		nwb->box = {nwb->pos.x + makeTextureBig.x, nwb->pos.y, (float)tileSize, (float)tileSize};
-		walls.push_back(std::move(nwb));
+	for (int j = 0; j < walls.rows(); j++) {
+		walls.set(walls.columns() - 1, j, 1); // right column
+		walls.set(0, j, 1); // left column
 	}
 
-	for (int j = 0; j < screenH / tileSize; j++) {
-		// right column
-		auto nwr = std::make_unique<Wall>();
-		nwr->pos = vec2f(screenW - tileSize, j * tileSize);
-		nwr->box = {nwr->pos.x, nwr->pos.y, (float)tileSize, (float)tileSize};
-		printf("right column pos: %f, %f\n", nwr->box.x, nwr->box.y);
-		walls.push_back(std::move(nwr));
-		
-		// left column
-		auto nwl = std::make_unique<Wall>();
-		nwl->pos = vec2f(0, j * tileSize);
-		nwl->box = {nwl->pos.x, nwl->pos.y, (float)tileSize, (float)tileSize};
-		walls.push_back(std::move(nwl));
+	// scattered rocks so there's something to scroll past
+	for (int j = 4; j < walls.rows() - 4; j += 7) {
+		for (int i = 4 + j % 5; i < walls.columns() - 4; i += 9)
+			walls.set(i, j, 1);
 	}
 
-	std::cout << walls.size() << '\n';
+	Camera2D camera((float)screenW, (float)screenH);
+	camera.setBounds({0.0f, 0.0f, (float)worldW, (float)worldH});
+	camera.lookAt(vec2f(pp.x + pp.w / 2, pp.y + pp.h / 2));
+
+	Contact lastContact;
 
 	const double FPS = 240.0;
-	const double delay = 1000.0 / FPS;
+	GameLoop loop(120.0, FPS);
+
+	Input input;
 
 	SDL_Event ev;
 	bool active = true;
-	auto start = std::chrono::steady_clock::now();
 	while (active) {
 		while (SDL_PollEvent(&ev) != 0) {
+			input.handle(ev);
+
 			switch (ev.type) {
 				case SDL_QUIT:
 					active = false;
 					break;
 			}
 		}
-		auto end = std::chrono::steady_clock::now();
-		auto dt = std::chrono::duration<double, std::milli>(end - start);
-		start = end;
 
-		lastPos = ppPos;
+		loop.frame([&](double dt) {
+			lastPos = ppPos;
 
-		const uint8_t *keys = SDL_GetKeyboardState(NULL);
-		if (keys[SDL_SCANCODE_W]) {
-			//pp.y -= (int)(1 * dt.count());
-			ppPos.y -= (int)(1 * dt.count());
-			//makeTextureBig.y += 1 * dt.count();
-		}
-
-		if (keys[SDL_SCANCODE_A]) {
-			//pp.x -= (int)(1 * dt.count());
-			ppPos.x -= (int)(1 * dt.count());
-			//makeTextureBig.x += 1 * dt.count();
-		}
-
-		if (keys[SDL_SCANCODE_S]) {
-			//pp.y += (int)(1 * dt.count());
-			ppPos.y += (int)(1 * dt.count());
-			//makeTextureBig.y -= 1 * dt.count();
-		}
-
-		if (keys[SDL_SCANCODE_D]) {
-			//pp.x += (int)(1 * dt.count());
-			ppPos.x += (int)(1 * dt.count());
-			//makeTextureBig.x -= 1 * dt.count();
-		}
-
-		SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
-		SDL_RenderClear(lightning::strike.get());
+			input.tick();
+			vec2f dir = input.movement();
 
-		SDL_Rect dst = {0, 0, screenW, screenH};
+			// swept against the wall tiles, so fast moves can't tunnel and touching a wall slides along it
+			pp = {ppPos.x, ppPos.y, 35, 40};
+			MoveResult moved = move(walls, pp, dir * static_cast<float>(1 * dt));
+			ppPos = vec2f(pp.x, pp.y);
 
-		pp = {ppPos.x, ppPos.y, 35, 40};
-		
+			if (moved.contacts > 0)
+				lastContact = moved.first;
 
-		SDL_SetRenderTarget(lightning::strike.get(), target);
-		SDL_RenderCopy(lightning::strike.get(), map.get(), &dst, nullptr);
-		SDL_SetRenderTarget(lightning::strike.get(), nullptr);
+			camera.follow(vec2f(pp.x + pp.w / 2, pp.y + pp.h / 2), static_cast<float>(dt));
+		}, [&](double alpha) {
+			SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
+			SDL_RenderClear(lightning::strike.get());
 
-		drawTexture(target, lightning::strike.get(), makeTextureBig.x, makeTextureBig.y);
+			Camera2D view = camera.at(static_cast<float>(alpha));
 
-		printf("%f, %f\n", pp.x, pp.y);
-
-		for (const auto &wall : walls) {
-
-			auto collide = SDL_HasIntersectionF(&pp, &wall->box);
-
-			// set walls to stick to the target texture
-
-			wall->draw();
-			
-			if (!collide) {
-				SDL_SetRenderDrawColor(lightning::strike.get(), 255, 0, 0, 255);
-				SDL_RenderDrawRectF(lightning::strike.get(), &wall->box);
-				//lastPos = ppPos;
-				//lastPos = vec2f(pp.x, pp.y);
-
-			} else {
-				SDL_SetRenderDrawColor(lightning::strike.get(), 0, 255, 0, 255);
-				SDL_RenderDrawRectF(lightning::strike.get(), &wall->box);
-				//printf("colliding\n");
-				//vec2f(pp.x, pp.y) = lastPos;
-				ppPos = lastPos;
-				//ppPos = vec2f(0, 0);
-			}
-			
-		}
+			// the background is stretched over the whole world, the renderer clips what's off screen
+			SDL_FRect mapDst = view.worldToScreen(SDL_FRect {0.0f, 0.0f, (float)worldW, (float)worldH});
+			SDL_RenderCopyF(lightning::strike.get(), map.get(), nullptr, &mapDst);
 
-		SDL_SetRenderDrawColor(lightning::strike.get(), 255, 0, 0, 255);
-		SDL_RenderFillRectF(lightning::strike.get(), &pp);
+			walls.draw(lightning::strike.get(), view);
 
-		SDL_RenderPresent(lightning::strike.get());
+			SDL_FRect worldPP = {lastPos.x + (ppPos.x - lastPos.x) * (float)alpha, lastPos.y + (ppPos.y - lastPos.y) * (float)alpha, pp.w, pp.h};
+			SDL_FRect drawPP = view.worldToScreen(worldPP);
 
-		if (delay > dt.count())
-			SDL_Delay(delay - dt.count());
+			SDL_SetRenderDrawColor(lightning::strike.get(), 255, 0, 0, 255);
+			SDL_RenderFillRectF(lightning::strike.get(), &drawPP);
 
-		printf("%f, %f\n", lastPos.x, lastPos.y);
+			// last wall normal the player slid along
+			float cx = drawPP.x + drawPP.w / 2, cy = drawPP.y + drawPP.h / 2;
+			SDL_SetRenderDrawColor(lightning::strike.get(), 0, 255, 0, 255);
+			SDL_RenderDrawLineF(lightning::strike.get(), cx, cy, cx + lastContact.normal.x * 30.0f, cy + lastContact.normal.y * 30.0f);
 
+			SDL_RenderPresent(lightning::strike.get());
+		});
 	}
 
-	SDL_DestroyTexture(target);
+	lightning::textures.clear();
 	SDL_Quit();
 
 	return 0;
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SDL.h>
+#include "vector2.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace gmtk {
+	/**
+	 * World-space view: center, zoom and the size of the viewport in pixels
+	 * Update it at the fixed step, then draw through at(alpha) so scrolling is as smooth as the sprites
+	 */
+	class Camera2D {
+	public:
+		Camera2D(float viewWidth, float viewHeight) : viewW(viewWidth), viewH(viewHeight) {}
+
+		void setViewport(float w, float h) noexcept {
+			viewW = w;
+			viewH = h;
+			clamp();
+		}
+
+		// keeps the view inside the world; a world smaller than the view stays centered
+		void setBounds(const SDL_FRect &world) noexcept {
+			bounds = world;
+			bounded = true;
+			clamp();
+		}
+
+		void setZoom(float z) noexcept {
+			zoom = std::max(z, 0.01f);
+			clamp();
+		}
+
+		void lookAt(vec2f target) noexcept {
+			center = target;
+			clamp();
+			previous = center;
+		}
+
+		/**
+		 * Eases toward target, halfLife is how many ms it takes to close half the distance (0 snaps)
+		 * Frame rate independent, so it behaves the same at any tick rate
+		 */
+		void follow(vec2f target, float dt, float halfLife = 80.0f) noexcept {
+			previous = center;
+
+			float t = halfLife > 0.0f ? 1.0f - std::exp2(-dt / halfLife) : 1.0f;
+			center.x += (target.x - center.x) * t;
+			center.y += (target.y - center.y) * t;
+			clamp();
+		}
+
+		// the camera blended between its last two steps, for drawing
+		Camera2D at(float alpha) const noexcept {
+			Camera2D cam = *this;
+			cam.center = vec2f(previous.x + (center.x - previous.x) * alpha, previous.y + (center.y - previous.y) * alpha);
+			cam.previous = cam.center;
+			return cam;
+		}
+
+		// world rect that's on screen
+		SDL_FRect view() const noexcept {
+			float w = viewW / zoom, h = viewH / zoom;
+			return {center.x - w * 0.5f, center.y - h * 0.5f, w, h};
+		}
+
+		vec2f worldToScreen(vec2f p) const noexcept {
+			SDL_FRect v = view();
+			return vec2f((p.x - v.x) * zoom, (p.y - v.y) * zoom);
+		}
+
+		SDL_FRect worldToScreen(const SDL_FRect &r) const noexcept {
+			SDL_FRect v = view();
+			return {(r.x - v.x) * zoom, (r.y - v.y) * zoom, r.w * zoom, r.h * zoom};
+		}
+
+		vec2f screenToWorld(vec2f p) const noexcept {
+			SDL_FRect v = view();
+			return vec2f(v.x + p.x / zoom, v.y + p.y / zoom);
+		}
+
+		bool visible(const SDL_FRect &r) const noexcept {
+			SDL_FRect v = view();
+			return r.x < v.x + v.w && r.x + r.w > v.x && r.y < v.y + v.h && r.y + r.h > v.y;
+		}
+
+		vec2f position() const noexcept { return center; }
+		float scale() const noexcept { return zoom; }
+		float width() const noexcept { return viewW; }
+		float height() const noexcept { return viewH; }
+
+	private:
+		void clamp() noexcept {
+			if (!bounded)
+				return;
+
+			float w = viewW / zoom, h = viewH / zoom;
+			if (w >= bounds.w)
+				center.x = bounds.x + bounds.w * 0.5f;
+			else
+				center.x = std::clamp(center.x, bounds.x + w * 0.5f, bounds.x + bounds.w - w * 0.5f);
+
+			if (h >= bounds.h)
+				center.y = bounds.y + bounds.h * 0.5f;
+			else
+				center.y = std::clamp(center.y, bounds.y + h * 0.5f, bounds.y + bounds.h - h * 0.5f);
+		}
+
+	private:
+		float viewW, viewH;
+		float zoom {1.0f};
+		vec2f center;
+		vec2f previous;
+		SDL_FRect bounds {0.0f, 0.0f, 0.0f, 0.0f};
+		bool bounded {false};
+	};
+} // namespace gmtk
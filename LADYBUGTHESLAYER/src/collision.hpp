@@ -0,0 +1,279 @@
+#pragma once
+
+#include <SDL.h>
+#include "components.hpp"
+#include "ecs.hpp"
+#include "jobs.hpp"
+#include "spatial.hpp"
+#include "tilemap.hpp"
+#include "vector2.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace gmtk {
+	struct Contact {
+		float time {1.0f}; // fraction of the move done before touching, 1 when nothing was hit
+		vec2f normal; // points away from the surface that was hit
+	};
+
+	struct MoveResult {
+		vec2f delta; // what the box actually moved by after sliding
+		Contact first; // earliest contact of the move, if any
+		int contacts {0};
+		bool blockedX {false}, blockedY {false};
+	};
+
+	/**
+	 * Swept AABB: when box moving by delta first touches target
+	 * Boxes that already overlap don't count as a hit so a mover that starts stuck can still walk out
+	 */
+	inline bool sweep(const SDL_FRect &box, vec2f delta, const SDL_FRect &target, Contact &out) noexcept {
+		constexpr float inf = std::numeric_limits<float>::infinity();
+
+		// distance to the near and far side of target along each axis
+		float entryX, exitX, entryY, exitY;
+		if (delta.x > 0.0f) {
+			entryX = target.x - (box.x + box.w);
+			exitX = (target.x + target.w) - box.x;
+		} else {
+			entryX = (target.x + target.w) - box.x;
+			exitX = target.x - (box.x + box.w);
+		}
+
+		if (delta.y > 0.0f) {
+			entryY = target.y - (box.y + box.h);
+			exitY = (target.y + target.h) - box.y;
+		} else {
+			entryY = (target.y + target.h) - box.y;
+			exitY = target.y - (box.y + box.h);
+		}
+
+		float tEntryX, tExitX, tEntryY, tExitY;
+		if (delta.x == 0.0f) {
+			// not moving on x, it has to overlap on x the whole way
+			if (box.x + box.w <= target.x || box.x >= target.x + target.w)
+				return false;
+			tEntryX = -inf;
+			tExitX = inf;
+		} else {
+			tEntryX = entryX / delta.x;
+			tExitX = exitX / delta.x;
+		}
+
+		if (delta.y == 0.0f) {
+			if (box.y + box.h <= target.y || box.y >= target.y + target.h)
+				return false;
+			tEntryY = -inf;
+			tExitY = inf;
+		} else {
+			tEntryY = entryY / delta.y;
+			tExitY = exitY / delta.y;
+		}
+
+		float entry = std::max(tEntryX, tEntryY);
+		float exit = std::min(tExitX, tExitY);
+
+		if (entry > exit || entry < 0.0f || entry > 1.0f)
+			return false;
+
+		out.time = entry;
+		if (tEntryX > tEntryY)
+			out.normal = vec2f(delta.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+		else
+			out.normal = vec2f(0.0f, delta.y > 0.0f ? -1.0f : 1.0f);
+		return true;
+	}
+
+	/**
+	 * Finds the earliest contact of box moving by delta against solid tiles and (optionally) the boxes in colliders
+	 * Only the tiles / cells covered by the swept box are looked at
+	 */
+	inline bool earliestContact(const TileMap &map, const SpatialGrid *colliders, SpatialGrid::Proxy self, const SDL_FRect &box, vec2f delta, Contact &out) {
+		SDL_FRect swept = {
+			std::min(box.x, box.x + delta.x), std::min(box.y, box.y + delta.y),
+			box.w + std::abs(delta.x), box.h + std::abs(delta.y),
+		};
+
+		bool hit = false;
+		Contact best;
+		Contact c;
+
+		const float size = static_cast<float>(map.tileSize());
+		int firstCol = static_cast<int>(std::floor(swept.x / size)), lastCol = static_cast<int>(std::floor((swept.x + swept.w) / size));
+		int firstRow = static_cast<int>(std::floor(swept.y / size)), lastRow = static_cast<int>(std::floor((swept.y + swept.h) / size));
+		firstCol = std::max(firstCol, 0);
+		firstRow = std::max(firstRow, 0);
+		lastCol = std::min(lastCol, map.columns() - 1);
+		lastRow = std::min(lastRow, map.rows() - 1);
+
+		for (int row = firstRow; row <= lastRow; ++row) {
+			for (int col = firstCol; col <= lastCol; ++col) {
+				if (!map.isSolid(col, row))
+					continue;
+
+				SDL_FRect tile = {col * size, row * size, size, size};
+				if (sweep(box, delta, tile, c) && c.time < best.time) {
+					best = c;
+					hit = true;
+				}
+			}
+		}
+
+		if (colliders != nullptr) {
+			colliders->queryShared(swept, [&](SpatialGrid::Proxy id) {
+				if (id != self && sweep(box, delta, colliders->box(id), c) && c.time < best.time) {
+					best = c;
+					hit = true;
+				}
+			});
+		}
+
+		if (hit)
+			out = best;
+		return hit;
+	}
+
+	/**
+	 * Moves box by delta, stopping at the first contact and sliding the rest of the move along it
+	 * Each pass can only remove one axis, so two passes cover a corner; a third catches the odd case
+	 * where sliding runs into another surface
+	 */
+	inline MoveResult move(const TileMap &map, const SpatialGrid *colliders, SpatialGrid::Proxy self, SDL_FRect &box, vec2f delta) {
+		// backs off contacts a hair so the next move doesn't start touching the wall
+		constexpr float skin = 0.001f;
+
+		MoveResult result;
+		vec2f start(box.x, box.y);
+
+		for (int pass = 0; pass < 3 && (delta.x != 0.0f || delta.y != 0.0f); ++pass) {
+			Contact c;
+			if (!earliestContact(map, colliders, self, box, delta, c)) {
+				box.x += delta.x;
+				box.y += delta.y;
+				break;
+			}
+
+			if (result.contacts++ == 0)
+				result.first = c;
+
+			float t = std::max(0.0f, c.time - skin / std::max(std::abs(delta.x) + std::abs(delta.y), skin));
+			box.x += delta.x * t;
+			box.y += delta.y * t;
+
+			// drop the part of the leftover move that pushes into the surface
+			vec2f rest = delta * (1.0f - t);
+			if (c.normal.x != 0.0f) {
+				rest.x = 0.0f;
+				result.blockedX = true;
+			} else {
+				rest.y = 0.0f;
+				result.blockedY = true;
+			}
+			delta = rest;
+		}
+
+		result.delta = vec2f(box.x, box.y) - start;
+		return result;
+	}
+
+	inline MoveResult move(const TileMap &map, SDL_FRect &box, vec2f delta) {
+		return move(map, nullptr, SpatialGrid::invalid, box, delta);
+	}
+
+	/**
+	 * Batched version for every entity with Transform, Velocity and Collider
+	 * Movers are swept one after another against the tiles and the grid as it stands, so one
+	 * that already moved this pass is hit where it ended up; velocity into a wall is zeroed
+	 * Colliders need to be in the grid already (syncColliders) for movers to block each other
+	 */
+	inline size_t resolveMovers(Registry &reg, const TileMap &map, SpatialGrid *colliders, float dt) {
+		size_t blocked = 0;
+
+		reg.view<Transform, Velocity, Collider>().each([&](Entity, Transform &t, Velocity &v, Collider &c) {
+			if (v.x == 0.0f && v.y == 0.0f)
+				return;
+
+			SDL_FRect box = {t.x + c.offsetX, t.y + c.offsetY, c.w, c.h};
+			MoveResult result = move(map, colliders, c.proxy, box, vec2f(v.x * dt, v.y * dt));
+
+			t.x += result.delta.x;
+			t.y += result.delta.y;
+
+			if (result.blockedX)
+				v.x = 0.0f;
+			if (result.blockedY)
+				v.y = 0.0f;
+			if (result.contacts > 0)
+				++blocked;
+
+			if (colliders != nullptr && c.proxy != SpatialGrid::invalid)
+				colliders->move(c.proxy, box);
+		});
+
+		return blocked;
+	}
+
+	/**
+	 * resolveMovers split over the job system
+	 * Every mover sweeps against the grid as it stood when the pass began, so two movers can step into each
+	 * other in the same tick (overlaps don't block, they walk apart on the next one); the grid is only written
+	 * afterwards, on the calling thread, from the boxes left in moved
+	 */
+	inline size_t resolveMovers(Registry &reg, const TileMap &map, SpatialGrid *colliders, float dt, JobSystem &jobs, std::vector<SDL_FRect> &moved) {
+		auto &velocities = reg.pool<Velocity>();
+		auto &transforms = reg.pool<Transform>();
+		auto &bodies = reg.pool<Collider>();
+		const Entity *ids = velocities.data();
+		Velocity *v = velocities.raw();
+		std::atomic<size_t> blocked {0};
+
+		// negative width marks the ones that didn't move
+		moved.assign(velocities.size(), SDL_FRect {0.0f, 0.0f, -1.0f, -1.0f});
+
+		jobs.parallelFor(velocities.size(), [&](size_t begin, size_t end) {
+			size_t hits = 0;
+			for (size_t i = begin; i < end; ++i) {
+				if (v[i].x == 0.0f && v[i].y == 0.0f)
+					continue;
+
+				Transform *t = transforms.tryGet(ids[i]);
+				Collider *c = bodies.tryGet(ids[i]);
+				if (t == nullptr || c == nullptr)
+					continue;
+
+				SDL_FRect box = {t->x + c->offsetX, t->y + c->offsetY, c->w, c->h};
+				MoveResult result = move(map, colliders, c->proxy, box, vec2f(v[i].x * dt, v[i].y * dt));
+
+				t->x += result.delta.x;
+				t->y += result.delta.y;
+
+				if (result.blockedX)
+					v[i].x = 0.0f;
+				if (result.blockedY)
+					v[i].y = 0.0f;
+				if (result.contacts > 0)
+					++hits;
+
+				moved[i] = box;
+			}
+			blocked += hits;
+		});
+
+		if (colliders != nullptr) {
+			for (size_t i = 0; i < moved.size(); ++i) {
+				if (moved[i].w < 0.0f)
+					continue;
+
+				SpatialGrid::Proxy proxy = bodies.get(ids[i]).proxy;
+				if (proxy != SpatialGrid::invalid)
+					colliders->move(proxy, moved[i]);
+			}
+		}
+
+		return blocked.load();
+	}
+} // namespace gmtk
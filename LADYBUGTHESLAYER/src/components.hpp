@@ -0,0 +1,212 @@
+#pragma once
+
+#include <SDL.h>
+#include "animation.hpp"
+#include "batch.hpp"
+#include "camera.hpp"
+#include "ecs.hpp"
+#include "jobs.hpp"
+#include "spatial.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace gmtk {
+	// previous is kept for render interpolation under the fixed timestep loop
+	struct Transform {
+		float x {0.0f}, y {0.0f};
+		float prevX {0.0f}, prevY {0.0f};
+	};
+
+	// pixels per millisecond
+	struct Velocity {
+		float x {0.0f}, y {0.0f};
+	};
+
+	// box offset from the transform, proxy is owned by syncColliders
+	struct Collider {
+		float offsetX {0.0f}, offsetY {0.0f};
+		float w {0.0f}, h {0.0f};
+		SpatialGrid::Proxy proxy {SpatialGrid::invalid};
+	};
+
+	// clip is rewritten every tick for animated sprites, set is optional
+	// tex holds a reference so TextureCache::purgeUnused can't free a sheet that's still on screen
+	struct Sprite {
+		Texture tex;
+		SDL_Rect clip {0, 0, 0, 0};
+		const AnimationSet *set {nullptr};
+		float scale {1.0f};
+		int layer {0};
+		SDL_RendererFlip flip {SDL_FLIP_NONE};
+	};
+
+	struct Health {
+		int hp {0};
+		int max {0};
+	};
+
+	/**
+	 * Systems: each one is a single pass over a view, nothing here is virtual
+	 */
+
+	// remembers where everything was so draws can blend into the new step
+	inline void storePrevious(Registry &reg) {
+		reg.pool<Transform>().each([](Entity, Transform &t) {
+			t.prevX = t.x;
+			t.prevY = t.y;
+		});
+	}
+
+	inline void integrate(Registry &reg, float dt) {
+		reg.view<Transform, Velocity>().each([dt](Entity, Transform &t, Velocity &v) {
+			t.x += v.x * dt;
+			t.y += v.y * dt;
+		});
+	}
+
+	// same as integrate, split over the job system; only the velocity pool is walked
+	inline void integrate(Registry &reg, float dt, JobSystem &jobs) {
+		auto &velocities = reg.pool<Velocity>();
+		auto &transforms = reg.pool<Transform>();
+		const Entity *ids = velocities.data();
+		Velocity *v = velocities.raw();
+
+		jobs.parallelFor(velocities.size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				if (Transform *t = transforms.tryGet(ids[i])) {
+					t->x += v[i].x * dt;
+					t->y += v[i].y * dt;
+				}
+			}
+		});
+	}
+
+	inline void animate(Registry &reg, float dt) {
+		reg.view<AnimationState, Sprite>().each([dt](Entity, AnimationState &state, Sprite &sprite) {
+			if (sprite.set == nullptr || state.clip == invalidClip)
+				return;
+
+			advance(*sprite.set, state, dt);
+			sprite.clip = sprite.set->frame(state.clip, state.frame);
+		});
+	}
+
+	inline void animate(Registry &reg, float dt, JobSystem &jobs) {
+		auto &states = reg.pool<AnimationState>();
+		auto &sprites = reg.pool<Sprite>();
+		const Entity *ids = states.data();
+		AnimationState *state = states.raw();
+
+		jobs.parallelFor(states.size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				Sprite *sprite = sprites.tryGet(ids[i]);
+				if (sprite == nullptr || sprite->set == nullptr || state[i].clip == invalidClip)
+					continue;
+
+				advance(*sprite->set, state[i], dt);
+				sprite->clip = sprite->set->frame(state[i].clip, state[i].frame);
+			}
+		});
+	}
+
+	// moves every collider's proxy in the broadphase, inserting the ones that aren't in it yet
+	inline void syncColliders(Registry &reg, SpatialGrid &grid) {
+		reg.view<Transform, Collider>().each([&grid](Entity e, Transform &t, Collider &c) {
+			SDL_FRect box = {t.x + c.offsetX, t.y + c.offsetY, c.w, c.h};
+			if (c.proxy == SpatialGrid::invalid)
+				c.proxy = grid.insert(box, e);
+			else
+				grid.move(c.proxy, box);
+		});
+	}
+
+	// destroys every entity that ran out of health, pulling its proxy out of the grid first
+	inline size_t reapDead(Registry &reg, SpatialGrid *grid, std::vector<Entity> &scratch) {
+		scratch.clear();
+		reg.pool<Health>().each([&scratch](Entity e, Health &h) {
+			if (h.hp <= 0)
+				scratch.push_back(e);
+		});
+
+		for (Entity e : scratch) {
+			if (grid != nullptr) {
+				if (auto *c = reg.tryGet<Collider>(e))
+					grid->remove(c->proxy);
+			}
+			reg.destroy(e);
+		}
+
+		return scratch.size();
+	}
+
+	// world-space rect of a sprite blended between its last two steps
+	inline SDL_FRect spriteRect(const Transform &t, const Sprite &s, float alpha) {
+		SDL_FRect dst = {t.prevX + (t.x - t.prevX) * alpha, t.prevY + (t.y - t.prevY) * alpha, 0.0f, 0.0f};
+		if (s.clip.w > 0 && s.clip.h > 0) {
+			dst.w = s.clip.w * s.scale;
+			dst.h = s.clip.h * s.scale;
+		} else {
+			int w = 0, h = 0;
+			SDL_QueryTexture(s.tex.get(), nullptr, nullptr, &w, &h);
+			dst.w = w * s.scale;
+			dst.h = h * s.scale;
+		}
+		return dst;
+	}
+
+	inline void drawSprites(Registry &reg, SpriteBatch &batch, float alpha = 1.0f) {
+		reg.view<Transform, Sprite>().each([&batch, alpha](Entity, Transform &t, Sprite &s) {
+			if (s.tex == nullptr)
+				return;
+
+			const SDL_Rect *clip = (s.clip.w > 0 && s.clip.h > 0) ? &s.clip : nullptr;
+			batch.draw(s.tex.get(), spriteRect(t, s, alpha), clip, s.layer, s.flip);
+		});
+	}
+
+	// skips everything off screen and draws the rest through the camera
+	inline void drawSprites(Registry &reg, SpriteBatch &batch, const Camera2D &cam, float alpha = 1.0f) {
+		reg.view<Transform, Sprite>().each([&](Entity, Transform &t, Sprite &s) {
+			if (s.tex == nullptr)
+				return;
+
+			SDL_FRect dst = spriteRect(t, s, alpha);
+			if (!cam.visible(dst))
+				return;
+
+			const SDL_Rect *clip = (s.clip.w > 0 && s.clip.h > 0) ? &s.clip : nullptr;
+			batch.draw(s.tex.get(), cam.worldToScreen(dst), clip, s.layer, s.flip);
+		});
+	}
+
+	/**
+	 * Same, but only entities whose collider is near the view get looked at, so the cost follows
+	 * what's on screen rather than how many entities there are; sprites without a collider aren't drawn
+	 * margin covers sprites that hang outside their collider
+	 */
+	inline void drawSprites(Registry &reg, SpriteBatch &batch, const Camera2D &cam, const SpatialGrid &grid, float alpha = 1.0f, float margin = 64.0f) {
+		SDL_FRect area = cam.view();
+		area.x -= margin;
+		area.y -= margin;
+		area.w += margin * 2.0f;
+		area.h += margin * 2.0f;
+
+		auto &transforms = reg.pool<Transform>();
+		auto &sprites = reg.pool<Sprite>();
+
+		grid.queryShared(area, [&](SpatialGrid::Proxy id) {
+			Entity e = grid.userData(id);
+			Sprite *s = sprites.tryGet(e);
+			Transform *t = transforms.tryGet(e);
+			if (s == nullptr || t == nullptr || s->tex == nullptr)
+				return;
+
+			SDL_FRect dst = spriteRect(*t, *s, alpha);
+			if (!cam.visible(dst))
+				return;
+
+			const SDL_Rect *clip = (s->clip.w > 0 && s->clip.h > 0) ? &s->clip : nullptr;
+			batch.draw(s->tex.get(), cam.worldToScreen(dst), clip, s->layer, s->flip);
+		});
+	}
+} // namespace gmtk
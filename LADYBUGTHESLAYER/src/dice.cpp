@@ -1,9 +1,12 @@
 #include <SDL.h>
+#include "assets.hpp"
 #include "helper.hpp"
+#include "input.hpp"
+#include "random.hpp"
 #include <iostream>
 #include <memory>
 #include <chrono>
-#include <random>
+#include <cstdlib>
 
 struct Memory {
 	void operator()(SDL_Window *x) { SDL_DestroyWindow(x); }
@@ -15,8 +18,13 @@ using RNDRPTR = std::shared_ptr<SDL_Renderer>;
 
 namespace lightning {
 	RNDRPTR strike;
-	SDL_Point mousePos;
-	static std::mt19937_64 gen(std::random_device {}());
+	gmtk::AssetLoader assets;
+	// 0..50 plus some headroom for HUD strings
+	gmtk::TextCache labels {64};
+	// the label fonts, decoded in the background; labels wait for these instead of opening the font here
+	gmtk::AssetHandle<TTF_Font> digits, digitsOutline;
+	// seeded in main, pass a seed on the command line to replay a run
+	gmtk::RandomService random;
 }
 
 using namespace gmtk;
@@ -24,31 +32,42 @@ using namespace gmtk;
 class Dice {
 public:
 	Dice(int x, int y) : diceMin(x), diceMax(y) {
-		tex = loadTexture("assets/dice.png", lightning::strike.get());
-		auto dice1 = rollDice();
-		diceText = loadTextOutline(std::to_string(dice1), lightning::strike.get(), "assets/Onest.ttf", {0, 0, 0}, 48);
-		SDL_QueryTexture(tex.get(), nullptr, nullptr, &texWidth, &texHeight);
-		box = {xpos, ypos, (float)texWidth, (float)texHeight};
+		tex = lightning::assets.texture("assets/dice.png");
+		roll = rollDice();
+		box = {xpos, ypos, 0.0f, 0.0f};
 	}
 
-	int rollDice() { return dice(lightning::gen); }
+	int rollDice() { return rng.range(diceMin, diceMax); }
 
 	void draw() {
-		drawTexture(tex.get(), lightning::strike.get(), xpos, ypos);
-		drawTexture(diceText.get(), lightning::strike.get(), box.x, box.y);
+		drawTexture(tex.get().get(), lightning::strike.get(), xpos, ypos);
+		if (diceText != nullptr)
+			drawTexture(diceText.get(), lightning::strike.get(), box.x, box.y);
 	}
 
 	void update() {
 		box.x = xpos;
 		box.y = ypos;
+
+		// the size is only known once the sprite has finished loading
+		if (box.w == 0.0f && tex.ready()) {
+			SDL_QueryTexture(tex.get().get(), nullptr, nullptr, &texWidth, &texHeight);
+			box.w = (float)texWidth;
+			box.h = (float)texHeight;
+		}
+
+		// fontCache() already has both fonts once the loader is done, so this never opens one itself
+		if (diceText == nullptr && lightning::digits.ready() && lightning::digitsOutline.ready())
+			diceText = lightning::labels.get(std::to_string(roll), lightning::strike.get(), "assets/Onest.ttf", {0, 0, 0}, 48, true);
 	}
 
 	float xpos, ypos;
 
 private:
 	int diceMin, diceMax;
-	std::uniform_int_distribution<int> dice {diceMin, diceMax};
-	Texture tex;
+	int roll;
+	Rng &rng {lightning::random.stream("dice")};
+	AssetHandle<SDL_Texture> tex;
 	int texWidth;
 	int texHeight;
 	Texture diceText;
@@ -57,8 +76,11 @@ private:
 
 std::vector<std::unique_ptr<Dice>> diceList;
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
+	lightning::random.reseed(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : freshSeed());
+	std::cout << "seed " << lightning::random.seed() << '\n';
+
 	SDL_assert(SDL_Init(SDL_INIT_EVERYTHING) == 0);
 	SDL_assert(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) != 0);
 	if (TTF_Init() == -1) return false;
@@ -66,38 +88,48 @@ int main(int, char **)
 	auto window = WNDPTR(SDL_CreateWindow("", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, 0));
 	lightning::strike = RNDRPTR(SDL_CreateRenderer(window.get(), -1, SDL_RENDERER_ACCELERATED), SDL_DestroyRenderer);
 
+	// start decoding now so nothing blocks once the window is up
+	lightning::assets.setPlaceholder(AssetLoader::makePlaceholder(lightning::strike.get()));
+	lightning::assets.texture("assets/dice.png");
+	lightning::digits = lightning::assets.font("assets/Onest.ttf", 48);
+	lightning::digitsOutline = lightning::assets.font("assets/Onest.ttf", 48, 1);
+
 	const double FPS = 240.0;
 	const double delay = 1000.0 / FPS;
 
+	Input input;
+
 	SDL_Event ev;
 	bool active = true;
 	auto start = std::chrono::steady_clock::now();
 	while (active) {
 		while (SDL_PollEvent(&ev) != 0) {
+			input.handle(ev);
+
 			switch (ev.type) {
 				case SDL_QUIT:
 					active = false;
 					break;
-
-				case SDL_MOUSEBUTTONDOWN: {
-				case SDL_BUTTON_LEFT: {
-					auto dice = std::make_unique<Dice>(0, 50);
-					dice->xpos = lightning::mousePos.x;
-					dice->ypos = lightning::mousePos.y;
-					diceList.push_back(std::move(dice));
-				} break;
-				} break;
-
-				case SDL_MOUSEMOTION: {
-					lightning::mousePos.x = ev.motion.x;
-					lightning::mousePos.y = ev.motion.y;
-				}
 			}
 		}
 		auto end = std::chrono::steady_clock::now();
 		auto dt = std::chrono::duration<double, std::milli>(end - start);
 		start = end;
 
+		// one die per click, dropped where that click landed
+		input.tick();
+		for (const auto &click : input.events()) {
+			if (click.action != Action::attack || !click.down)
+				continue;
+
+			auto dice = std::make_unique<Dice>(0, 50);
+			dice->xpos = click.mouse.x;
+			dice->ypos = click.mouse.y;
+			diceList.push_back(std::move(dice));
+		}
+
+		lightning::assets.pump(lightning::strike.get());
+
 		SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
 		SDL_RenderClear(lightning::strike.get());
 
@@ -112,6 +144,10 @@ int main(int, char **)
 			SDL_Delay(delay - dt.count());
 	}
 
+	diceList.clear();
+	lightning::assets.shutdown();
+	lightning::labels.clear();
+	fontCache().clear();
 	SDL_Quit();
 
 	return 0;
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Entity ids pack a slot index (low 20 bits) and a version (high 12 bits)
+	 * The version is bumped on destroy so stale ids stop matching once their slot is reused
+	 */
+	using Entity = uint32_t;
+	static constexpr Entity nullEntity = UINT32_MAX;
+
+	namespace ecs {
+		static constexpr uint32_t indexBits = 20;
+		static constexpr uint32_t indexMask = (1u << indexBits) - 1;
+		static constexpr uint32_t versionMask = 0xfffu;
+
+		constexpr uint32_t index(Entity e) noexcept { return e & indexMask; }
+		constexpr uint32_t version(Entity e) noexcept { return e >> indexBits; }
+		constexpr Entity make(uint32_t index, uint32_t version) noexcept { return (version << indexBits) | index; }
+
+		// one id per component type, handed out the first time a type is used, which may be on a job thread
+		inline uint32_t nextTypeId() noexcept {
+			static std::atomic<uint32_t> counter {0};
+			return counter.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		template <typename T>
+		uint32_t typeId() noexcept {
+			static const uint32_t id = nextTypeId();
+			return id;
+		}
+	} // namespace ecs
+
+	class PoolBase {
+	public:
+		virtual ~PoolBase() = default;
+		virtual void remove(Entity e) = 0;
+		virtual void clear() = 0;
+	};
+
+	/**
+	 * Sparse set: a paged sparse array maps entity index -> dense slot, and the entities / components
+	 * sit packed side by side in two dense arrays, so iterating a pool is a straight walk over memory
+	 * Removal swaps the last element into the hole, which means order isn't stable
+	 */
+	template <typename T>
+	class ComponentPool final : public PoolBase {
+	public:
+		template <typename... Args>
+		T &emplace(Entity e, Args &&...args) {
+			uint32_t &slot = sparseSlot(ecs::index(e));
+			if (slot != invalid) {
+				dense[slot] = T {std::forward<Args>(args)...};
+				return dense[slot];
+			}
+
+			slot = static_cast<uint32_t>(entities.size());
+			entities.push_back(e);
+			dense.push_back(T {std::forward<Args>(args)...});
+			return dense.back();
+		}
+
+		void remove(Entity e) override {
+			uint32_t idx = ecs::index(e);
+			if (!contains(e))
+				return;
+
+			uint32_t slot = pages[idx / pageSize][idx % pageSize];
+			uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+			if (slot != last) {
+				Entity moved = entities[last];
+				entities[slot] = moved;
+				dense[slot] = std::move(dense[last]);
+				uint32_t movedIdx = ecs::index(moved);
+				pages[movedIdx / pageSize][movedIdx % pageSize] = slot;
+			}
+
+			entities.pop_back();
+			dense.pop_back();
+			pages[idx / pageSize][idx % pageSize] = invalid;
+		}
+
+		void clear() override {
+			for (Entity e : entities) {
+				uint32_t idx = ecs::index(e);
+				pages[idx / pageSize][idx % pageSize] = invalid;
+			}
+			entities.clear();
+			dense.clear();
+		}
+
+		bool contains(Entity e) const noexcept {
+			uint32_t idx = ecs::index(e);
+			size_t page = idx / pageSize;
+			if (page >= pages.size() || pages[page] == nullptr)
+				return false;
+
+			uint32_t slot = pages[page][idx % pageSize];
+			return slot != invalid && entities[slot] == e;
+		}
+
+		T &get(Entity e) {
+			uint32_t idx = ecs::index(e);
+			return dense[pages[idx / pageSize][idx % pageSize]];
+		}
+
+		T *tryGet(Entity e) { return contains(e) ? &get(e) : nullptr; }
+
+		// calls fn(entity, component) over the dense arrays
+		template <typename F>
+		void each(F &&fn) {
+			for (size_t i = 0; i < dense.size(); ++i)
+				fn(entities[i], dense[i]);
+		}
+
+		void reserve(size_t count) {
+			entities.reserve(count);
+			dense.reserve(count);
+		}
+
+		size_t size() const noexcept { return dense.size(); }
+		const Entity *data() const noexcept { return entities.data(); }
+		T *raw() noexcept { return dense.data(); }
+
+	private:
+		static constexpr uint32_t invalid = UINT32_MAX;
+		static constexpr size_t pageSize = 4096;
+
+		// pages are allocated on first use so sparse ids don't cost a full array
+		uint32_t &sparseSlot(uint32_t idx) {
+			size_t page = idx / pageSize;
+			if (page >= pages.size())
+				pages.resize(page + 1);
+			if (pages[page] == nullptr) {
+				pages[page] = std::make_unique<uint32_t[]>(pageSize);
+				std::fill_n(pages[page].get(), pageSize, invalid);
+			}
+			return pages[page][idx % pageSize];
+		}
+
+	private:
+		std::vector<std::unique_ptr<uint32_t[]>> pages;
+		std::vector<Entity> entities;
+		std::vector<T> dense;
+	};
+
+	/**
+	 * Entities that have every one of Ts
+	 * Iteration walks the smallest pool densely and only probes the others, so a view over a rare
+	 * component is as cheap as that component's pool
+	 */
+	template <typename... Ts>
+	class View {
+	public:
+		explicit View(ComponentPool<Ts> *...pools) : pools(pools...) {}
+
+		// calls fn(entity, Ts &...); don't add or remove Ts while iterating, queue it up instead
+		template <typename F>
+		void each(F &&fn) {
+			PoolBase *lead = smallest();
+			(tryLead<Ts>(lead, fn) || ...);
+		}
+
+		size_t sizeHint() const noexcept {
+			size_t n = SIZE_MAX;
+			((n = std::min(n, std::get<ComponentPool<Ts> *>(pools)->size())), ...);
+			return n;
+		}
+
+	private:
+		PoolBase *smallest() const noexcept {
+			PoolBase *lead = nullptr;
+			size_t n = SIZE_MAX;
+			auto pick = [&](auto *pool) {
+				if (pool->size() < n) {
+					n = pool->size();
+					lead = pool;
+				}
+			};
+			(pick(std::get<ComponentPool<Ts> *>(pools)), ...);
+			return lead;
+		}
+
+		template <typename Lead, typename F>
+		bool tryLead(PoolBase *lead, F &fn) {
+			auto *pool = std::get<ComponentPool<Lead> *>(pools);
+			if (pool != lead)
+				return false;
+
+			// walk backwards so fn may destroy the current entity without skipping the one moved into its slot
+			const Entity *ids = pool->data();
+			for (size_t i = pool->size(); i > 0; --i) {
+				Entity e = ids[i - 1];
+				if ((std::get<ComponentPool<Ts> *>(pools)->contains(e) && ...))
+					fn(e, std::get<ComponentPool<Ts> *>(pools)->get(e)...);
+			}
+			return true;
+		}
+
+	private:
+		std::tuple<ComponentPool<Ts> *...> pools;
+	};
+
+	/**
+	 * Owns entity ids and one ComponentPool per component type
+	 * Components are plain structs; behaviour lives in free functions that run over views
+	 */
+	class Registry {
+	public:
+		Entity create() {
+			if (freeHead != nullEntity) {
+				uint32_t idx = freeHead;
+				uint32_t next = ecs::index(slots[idx]);
+				freeHead = next == ecs::indexMask ? nullEntity : next;
+				// the version was already bumped when the slot was freed
+				slots[idx] = ecs::make(idx, ecs::version(slots[idx]));
+				++liveCount;
+				return slots[idx];
+			}
+
+			// indexMask itself marks the end of the free list, so it can't be handed out
+			uint32_t idx = static_cast<uint32_t>(slots.size());
+			if (idx >= ecs::indexMask) {
+				std::cout << "Registry is out of entity ids (" << ecs::indexMask << " alive at once)\n";
+				std::abort();
+			}
+			slots.push_back(ecs::make(idx, 0));
+			++liveCount;
+			return slots.back();
+		}
+
+		void destroy(Entity e) {
+			if (!valid(e))
+				return;
+
+			for (auto &pool : pools) {
+				if (pool != nullptr)
+					pool->remove(e);
+			}
+
+			uint32_t idx = ecs::index(e);
+			uint32_t next = (ecs::version(e) + 1) & ecs::versionMask;
+			// a free slot stores the next free index in place of its own
+			slots[idx] = ecs::make(freeHead == nullEntity ? ecs::indexMask : freeHead, next);
+			freeHead = idx;
+			--liveCount;
+		}
+
+		bool valid(Entity e) const noexcept {
+			uint32_t idx = ecs::index(e);
+			return e != nullEntity && idx < slots.size() && slots[idx] == e;
+		}
+
+		template <typename T, typename... Args>
+		T &emplace(Entity e, Args &&...args) {
+			return pool<T>().emplace(e, std::forward<Args>(args)...);
+		}
+
+		template <typename T>
+		void remove(Entity e) {
+			pool<T>().remove(e);
+		}
+
+		template <typename T>
+		bool has(Entity e) {
+			return pool<T>().contains(e);
+		}
+
+		template <typename T>
+		T &get(Entity e) {
+			return pool<T>().get(e);
+		}
+
+		template <typename T>
+		T *tryGet(Entity e) {
+			return pool<T>().tryGet(e);
+		}
+
+		template <typename... Ts>
+		View<Ts...> view() {
+			return View<Ts...>(&pool<Ts>()...);
+		}
+
+		template <typename T>
+		ComponentPool<T> &pool() {
+			uint32_t id = ecs::typeId<T>();
+			if (id >= pools.size())
+				pools.resize(id + 1);
+			if (pools[id] == nullptr)
+				pools[id] = std::make_unique<ComponentPool<T>>();
+			return static_cast<ComponentPool<T> &>(*pools[id]);
+		}
+
+		void clear() {
+			for (auto &pool : pools) {
+				if (pool != nullptr)
+					pool->clear();
+			}
+			slots.clear();
+			freeHead = nullEntity;
+			liveCount = 0;
+		}
+
+		size_t size() const noexcept { return liveCount; }
+
+	private:
+		std::vector<Entity> slots;
+		std::vector<std::unique_ptr<PoolBase>> pools;
+		uint32_t freeHead {nullEntity};
+		size_t liveCount {0};
+	};
+} // namespace gmtk
@@ -2,9 +2,15 @@
 
 #include <SDL.h>
 #include <iostream>
+#include "components.hpp"
+#include "ecs.hpp"
+#include "flowfield.hpp"
+#include "gameloop.hpp"
 #include "vector2.hpp"
+#include <algorithm>
 #include <memory>
 #include <chrono>
+#include <random>
 
 struct Memory {
 	void operator()(SDL_Window *x) { SDL_DestroyWindow(x); }
@@ -19,51 +25,55 @@ namespace lightning {
 	uint32_t w {1024}, h {768};
 }
 
-static double distanceBetweenEntities(const SDL_Rect &e1, const SDL_Rect &e2) {
-	double dist = std::abs(std::sqrt(std::pow(e2.x - e1.x, 2) + std::pow(e2.y - e1.y, 2)));
-	return dist;
-}
-
 double mlerp(double a, double b, double t)
 {
 	return (1 - t) * a + t * b;
 }
 
-using namespace gmtk;
-
-// credit unity
-vec2d moveTowards(vec2d current, vec2d target, float maxDistDelta) {
-	vec2d a = target - current;
-
-	float mag = std::abs(std::sqrt(std::pow(current.x - target.x, 2) + std::pow(current.y - target.y, 2)));
-
-	if (mag <= maxDistDelta || mag == 0.f) {
-		return target;
-	}
-
-	double x = current.x + a.x / mag * maxDistDelta;
-	double y = current.y + a.y / mag * maxDistDelta;
-
-	return vec2d(x, y);
+// blends two simulation states for rendering
+static SDL_Rect lerpRect(const SDL_Rect &a, const SDL_Rect &b, double t) {
+	return {(int)mlerp(a.x, b.x, t), (int)mlerp(a.y, b.y, t), b.w, b.h};
 }
 
+using namespace gmtk;
+
 int main(int, char **)
 {
 	SDL_assert(SDL_Init(SDL_INIT_EVERYTHING) == 0);
 
-	auto start = std::chrono::steady_clock::now();
-
 	auto window = WNDPTR(SDL_CreateWindow("", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, 0));
 	lightning::strike = RNDRPTR(SDL_CreateRenderer(window.get(), -1, SDL_RENDERER_ACCELERATED));
 
 	SDL_Rect pp = {lightning::w / 2, lightning::h / 2, 25, 25};
-	SDL_Rect ep = {0, 0, 25, 25};
+	SDL_Rect lastPP = pp;
+
+	// a few walls for the swarm to path around
+	const int tileSize = 32;
+	FlowField field(lightning::w / tileSize, lightning::h / tileSize, (float)tileSize);
+	for (int row = 4; row < 20; ++row) {
+		field.setSolid(8, row, true);
+		field.setSolid(23, 23 - row, true);
+	}
+	for (int col = 12; col < 20; ++col)
+		field.setSolid(col, 6, true);
+
+	// every enemy reads the same field, so adding more only costs the per-agent lookup
+	Registry enemies;
+	std::mt19937 gen(7);
+	std::uniform_real_distribution<float> across(0.0f, (float)lightning::w), speed(0.15f, 0.35f);
+	for (int i = 0; i < 300; ++i) {
+		float x = across(gen), y = i % 2 == 0 ? 0.0f : (float)lightning::h - tileSize;
+		if (field.isSolid((int)(x / tileSize), (int)(y / tileSize)))
+			continue;
+
+		Entity e = enemies.create();
+		enemies.emplace<Transform>(e, x, y, x, y);
+		enemies.emplace<Velocity>(e);
+		enemies.emplace<Pursuer>(e, speed(gen));
+	}
 
 	const double FPS = 240.0;
-	const double delay = 1000.0 / FPS;
-
-	float x = 0.f;
-	float y = 0.f;
+	GameLoop loop(120.0, FPS);
 
 	SDL_Event ev;
 	bool active = true;
@@ -75,52 +85,71 @@ int main(int, char **)
 					break;
 			}
 		}
-		auto end = std::chrono::steady_clock::now();
-		auto dt = std::chrono::duration<double, std::milli>(end - start);
-		start = end;
 
-		const uint8_t *keys = SDL_GetKeyboardState(NULL);
-		if (keys[SDL_SCANCODE_W]) {
-			pp.y -= (int)(1 * dt.count());
-		}
+		loop.frame([&](double dt) {
+			lastPP = pp;
 
-		if (keys[SDL_SCANCODE_A]) {
-			pp.x -= (int)(1 * dt.count());
-		}
+			const uint8_t *keys = SDL_GetKeyboardState(NULL);
+			if (keys[SDL_SCANCODE_W]) {
+				pp.y -= (int)(1 * dt);
+			}
 
-		if (keys[SDL_SCANCODE_S]) {
-			pp.y += (int)(1 * dt.count());
-		}
+			if (keys[SDL_SCANCODE_A]) {
+				pp.x -= (int)(1 * dt);
+			}
 
-		if (keys[SDL_SCANCODE_D]) {
-			pp.x += (int)(1 * dt.count());
-		}
+			if (keys[SDL_SCANCODE_S]) {
+				pp.y += (int)(1 * dt);
+			}
+
+			if (keys[SDL_SCANCODE_D]) {
+				pp.x += (int)(1 * dt);
+			}
 
-		float dist = distanceBetweenEntities(pp, ep);
+			// the field can only lead to somewhere on the grid
+			pp.x = std::clamp(pp.x, 0, static_cast<int>(lightning::w) - pp.w);
+			pp.y = std::clamp(pp.y, 0, static_cast<int>(lightning::h) - pp.h);
 
-		std::cout << ep.x << ", " << ep.y << '\n';
+			// only rebuilds when the player has crossed into another cell
+			vec2f target(pp.x + pp.w / 2.0f, pp.y + pp.h / 2.0f);
+			field.update(target);
 
-		vec2d ep2d = moveTowards(vec2d(ep.x, ep.y), vec2d(pp.x, pp.y), (1 * dt.count()) / 2);
+			storePrevious(enemies);
+			followField(enemies, field, target, vec2f(12.5f, 12.5f));
+			integrate(enemies, static_cast<float>(dt));
+		}, [&](double alpha) {
+			SDL_Rect drawPP = lerpRect(lastPP, pp, alpha);
 
-		ep.x = ep2d.x;
-		ep.y = ep2d.y;
+			SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
+			SDL_RenderClear(lightning::strike.get());
 
-		SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
-		SDL_RenderClear(lightning::strike.get());
+			SDL_SetRenderDrawColor(lightning::strike.get(), 90, 90, 90, 255);
+			for (int row = 0; row < field.rows(); ++row) {
+				for (int col = 0; col < field.columns(); ++col) {
+					if (!field.isSolid(col, row))
+						continue;
 
-		SDL_SetRenderDrawColor(lightning::strike.get(), 255, 0, 0, 255);
-		SDL_RenderFillRect(lightning::strike.get(), &ep);
+					SDL_Rect wall = {col * tileSize, row * tileSize, tileSize, tileSize};
+					SDL_RenderFillRect(lightning::strike.get(), &wall);
+				}
+			}
 
-		SDL_SetRenderDrawColor(lightning::strike.get(), 255, 255, 255, 255);
-		SDL_RenderFillRect(lightning::strike.get(), &pp);
+			SDL_SetRenderDrawColor(lightning::strike.get(), 255, 0, 0, 255);
+			enemies.pool<Transform>().each([&](Entity, Transform &t) {
+				float a = static_cast<float>(alpha);
+				SDL_FRect drawEP = {t.prevX + (t.x - t.prevX) * a, t.prevY + (t.y - t.prevY) * a, 25.0f, 25.0f};
+				SDL_RenderFillRectF(lightning::strike.get(), &drawEP);
+			});
 
-		SDL_RenderPresent(lightning::strike.get());
+			SDL_SetRenderDrawColor(lightning::strike.get(), 255, 255, 255, 255);
+			SDL_RenderFillRect(lightning::strike.get(), &drawPP);
 
-		if (delay > dt.count())
-			SDL_Delay(delay - dt.count());
+			SDL_RenderPresent(lightning::strike.get());
+		});
 	}
 
+	enemies.clear();
 	SDL_Quit();
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <SDL.h>
+#include "components.hpp"
+#include "ecs.hpp"
+#include "jobs.hpp"
+#include "tilemap.hpp"
+#include "vector2.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gmtk {
+	// tag for entities that chase whatever the flow field points at, speed in pixels per ms
+	struct Pursuer {
+		float speed {0.1f};
+	};
+
+	/**
+	 * Shared pathing toward one target over a wall grid
+	 * A breadth first integration field is grown out from the target's cell, then every open cell
+	 * stores which of its 8 neighbours is closest to the target; agents just read their cell
+	 * The field only rebuilds when the target changes cell or a wall changes, and the rebuild can be
+	 * spread over several ticks while agents keep following the previous field
+	 */
+	class FlowField {
+	public:
+		static constexpr uint16_t unreachable = UINT16_MAX;
+		static constexpr uint8_t none = 8;
+
+		FlowField(int columns, int rows, float cellSize)
+			: cols(columns), rowCount(rows), size(cellSize), invSize(1.0f / cellSize) {
+			size_t n = static_cast<size_t>(cols) * rowCount;
+			solid.assign(n, 0);
+			cost.assign(n, unreachable);
+			building.assign(n, unreachable);
+			dirs.assign(n, none);
+			open.reserve(n);
+		}
+
+		void setSolid(int col, int row, bool isSolid) {
+			if (!contains(col, row))
+				return;
+
+			auto &cell = solid[index(col, row)];
+			if (cell == static_cast<uint8_t>(isSolid))
+				return;
+
+			cell = static_cast<uint8_t>(isSolid);
+			wallsChanged = true;
+		}
+
+		// copies the solid tiles of a map with the same layout
+		void loadWalls(const TileMap &map) {
+			for (int row = 0; row < rowCount; ++row) {
+				for (int col = 0; col < cols; ++col)
+					setSolid(col, row, map.isSolid(col, row));
+			}
+		}
+
+		/**
+		 * Call every tick with the target's world position
+		 * budget caps how many cells get expanded this call, 0 finishes the rebuild right away
+		 * Returns true when a new field was swapped in
+		 */
+		bool update(vec2f target, size_t budget = 0) {
+			int col = static_cast<int>(std::floor(target.x * invSize));
+			int row = static_cast<int>(std::floor(target.y * invSize));
+
+			if (col != goalCol || row != goalRow || wallsChanged) {
+				goalCol = col;
+				goalRow = row;
+				wallsChanged = false;
+				begin();
+			}
+
+			if (!rebuilding)
+				return false;
+
+			return expand(budget);
+		}
+
+		// unit vector toward the target from a world position, zero in walls, unreachable cells and the goal cell
+		vec2f direction(float x, float y) const noexcept {
+			int col = static_cast<int>(std::floor(x * invSize));
+			int row = static_cast<int>(std::floor(y * invSize));
+			if (!contains(col, row))
+				return vec2f();
+
+			uint8_t dir = dirs[index(col, row)];
+			return dir == none ? vec2f() : vec2f(unit[dir].x, unit[dir].y);
+		}
+
+		// steps from here to the target, unreachable when walled off
+		uint16_t distance(float x, float y) const noexcept {
+			int col = static_cast<int>(std::floor(x * invSize));
+			int row = static_cast<int>(std::floor(y * invSize));
+			return contains(col, row) ? cost[index(col, row)] : unreachable;
+		}
+
+		bool isSolid(int col, int row) const noexcept { return !contains(col, row) || solid[index(col, row)] != 0; }
+
+		bool contains(int col, int row) const noexcept {
+			return col >= 0 && row >= 0 && col < cols && row < rowCount;
+		}
+
+		int columns() const noexcept { return cols; }
+		int rows() const noexcept { return rowCount; }
+		float cellSize() const noexcept { return size; }
+		bool pending() const noexcept { return rebuilding; }
+		size_t rebuilds() const noexcept { return rebuildCount; }
+
+	private:
+		struct Step {
+			int dx, dy;
+		};
+
+		// n, e, s, w first so the orthogonal neighbours can be checked before a diagonal
+		static constexpr Step steps[8] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {1, -1}, {1, 1}, {-1, 1}, {-1, -1}};
+		static constexpr SDL_FPoint unit[8] = {
+			{0.0f, -1.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f},
+			{0.70710678f, -0.70710678f}, {0.70710678f, 0.70710678f}, {-0.70710678f, 0.70710678f}, {-0.70710678f, -0.70710678f},
+		};
+
+		size_t index(int col, int row) const noexcept { return static_cast<size_t>(row) * cols + col; }
+
+		void begin() {
+			std::fill(building.begin(), building.end(), unreachable);
+			open.clear();
+			head = 0;
+			rebuilding = true;
+
+			// a target in a wall or off the grid pulls toward the closest cell that can be reached instead
+			int col = goalCol, row = goalRow;
+			if (!nearestOpen(col, row)) {
+				// nothing open at all, keep steering by the field we have
+				rebuilding = false;
+				return;
+			}
+
+			building[index(col, row)] = 0;
+			open.push_back(static_cast<uint32_t>(index(col, row)));
+		}
+
+		// moves col, row onto the closest open cell, searching rings outward from it clamped onto the grid
+		bool nearestOpen(int &col, int &row) const {
+			int cc = std::clamp(col, 0, cols - 1), cr = std::clamp(row, 0, rowCount - 1);
+			int maxRing = std::max(cols, rowCount);
+
+			for (int ring = 0; ring < maxRing; ++ring) {
+				int bestCol = -1, bestRow = -1;
+				long long bestDist = 0;
+
+				for (int r = cr - ring; r <= cr + ring; ++r) {
+					for (int c = cc - ring; c <= cc + ring; ++c) {
+						// only the edge of the ring, the inside was searched already
+						if (r != cr - ring && r != cr + ring && c != cc - ring && c != cc + ring)
+							continue;
+						if (isSolid(c, r))
+							continue;
+
+						long long dx = c - col, dy = r - row;
+						long long dist = dx * dx + dy * dy;
+						if (bestCol < 0 || dist < bestDist) {
+							bestCol = c;
+							bestRow = r;
+							bestDist = dist;
+						}
+					}
+				}
+
+				if (bestCol >= 0) {
+					col = bestCol;
+					row = bestRow;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool expand(size_t budget) {
+			size_t expanded = 0;
+			while (head < open.size()) {
+				if (budget != 0 && expanded == budget)
+					return false;
+
+				uint32_t cell = open[head++];
+				int col = static_cast<int>(cell % cols), row = static_cast<int>(cell / cols);
+				uint16_t next = static_cast<uint16_t>(building[cell] + 1);
+
+				// 4 connected, every step costs the same so a plain queue is enough
+				for (int i = 0; i < 4; ++i) {
+					int nc = col + steps[i].dx, nr = row + steps[i].dy;
+					if (!contains(nc, nr))
+						continue;
+
+					size_t n = index(nc, nr);
+					if (solid[n] || building[n] != unreachable)
+						continue;
+
+					building[n] = next;
+					open.push_back(static_cast<uint32_t>(n));
+				}
+				++expanded;
+			}
+
+			cost.swap(building);
+			bakeDirections();
+			rebuilding = false;
+			++rebuildCount;
+			return true;
+		}
+
+		void bakeDirections() {
+			for (int row = 0; row < rowCount; ++row) {
+				for (int col = 0; col < cols; ++col) {
+					size_t i = index(col, row);
+					uint16_t best = cost[i];
+					uint8_t dir = none;
+
+					if (best != unreachable && best != 0) {
+						for (uint8_t d = 0; d < 8; ++d) {
+							int nc = col + steps[d].dx, nr = row + steps[d].dy;
+							if (isSolid(nc, nr))
+								continue;
+
+							// no cutting corners past a wall
+							if (d >= 4 && (isSolid(col + steps[d].dx, row) || isSolid(col, row + steps[d].dy)))
+								continue;
+
+							uint16_t c = cost[index(nc, nr)];
+							if (c < best) {
+								best = c;
+								dir = d;
+							}
+						}
+					}
+
+					dirs[i] = dir;
+				}
+			}
+		}
+
+	private:
+		int cols, rowCount;
+		float size, invSize;
+		std::vector<uint8_t> solid;
+		std::vector<uint16_t> cost; // steps to the target, what agents read
+		std::vector<uint16_t> building; // the field being grown, swapped into cost once done
+		std::vector<uint8_t> dirs;
+		std::vector<uint32_t> open;
+		size_t head {0};
+		int goalCol {INT32_MIN}, goalRow {INT32_MIN};
+		bool wallsChanged {false};
+		bool rebuilding {false};
+		size_t rebuildCount {0};
+	};
+
+	/**
+	 * Points every pursuer along the field; inside the target's cell they head straight for it
+	 * center is the offset from the transform to the middle of the body
+	 */
+	inline void followField(Registry &reg, const FlowField &field, vec2f target, vec2f center = vec2f()) {
+		reg.view<Pursuer, Transform, Velocity>().each([&](Entity, Pursuer &p, Transform &t, Velocity &v) {
+			float x = t.x + center.x, y = t.y + center.y;
+			vec2f dir = field.direction(x, y);
+
+			if (dir.x == 0.0f && dir.y == 0.0f && field.distance(x, y) == 0) {
+				float dx = target.x - x, dy = target.y - y;
+				float lenSq = dx * dx + dy * dy;
+				// within a pixel, stop instead of jittering around the target
+				if (lenSq > 1.0f) {
+					float inv = 1.0f / std::sqrt(lenSq);
+					dir = vec2f(dx * inv, dy * inv);
+				}
+			}
+
+			v.x = dir.x * p.speed;
+			v.y = dir.y * p.speed;
+		});
+	}
+
+	// same as followField, split over the job system; the field is only read so ranges don't interfere
+	inline void followField(Registry &reg, const FlowField &field, vec2f target, JobSystem &jobs, vec2f center = vec2f()) {
+		auto &pursuers = reg.pool<Pursuer>();
+		auto &transforms = reg.pool<Transform>();
+		auto &velocities = reg.pool<Velocity>();
+		const Entity *ids = pursuers.data();
+		const Pursuer *p = pursuers.raw();
+
+		jobs.parallelFor(pursuers.size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				Transform *t = transforms.tryGet(ids[i]);
+				Velocity *v = velocities.tryGet(ids[i]);
+				if (t == nullptr || v == nullptr)
+					continue;
+
+				float x = t->x + center.x, y = t->y + center.y;
+				vec2f dir = field.direction(x, y);
+
+				if (dir.x == 0.0f && dir.y == 0.0f && field.distance(x, y) == 0) {
+					float dx = target.x - x, dy = target.y - y;
+					float lenSq = dx * dx + dy * dy;
+					if (lenSq > 1.0f) {
+						float inv = 1.0f / std::sqrt(lenSq);
+						dir = vec2f(dx * inv, dy * inv);
+					}
+				}
+
+				v->x = dir.x * p[i].speed;
+				v->y = dir.y * p[i].speed;
+			}
+		});
+	}
+} // namespace gmtk
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace gmtk {
+	/**
+	 * Fixed timestep loop: the simulation always advances in steps of the same size, rendering gets
+	 * an interpolation factor for the leftover time, and frames are paced by sleeping then spinning
+	 */
+	class GameLoop {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// frameHz of 0 leaves pacing to vsync (or nothing)
+		GameLoop(double updateHz = 120.0, double frameHz = 240.0, int maxSteps = 5)
+			: stepMs(1000.0 / updateHz), maxSteps(maxSteps) {
+			setFrameRate(frameHz);
+			last = Clock::now();
+			nextFrame = last;
+		}
+
+		void setFrameRate(double frameHz) {
+			frameMs = frameHz > 0.0 ? 1000.0 / frameHz : 0.0;
+		}
+
+		/**
+		 * Runs update(stepMs) as many times as the elapsed time calls for (up to maxSteps),
+		 * then render(alpha) where alpha is how far we are between the last two simulation states
+		 */
+		template <typename U, typename R>
+		void frame(U &&update, R &&render) {
+			auto now = Clock::now();
+			lastFrameMs = std::chrono::duration<double, std::milli>(now - last).count();
+			last = now;
+
+			// don't try to simulate a breakpoint or a dragged window
+			accumulator += std::min(lastFrameMs, 250.0);
+
+			int steps = 0;
+			while (accumulator >= stepMs && steps < maxSteps) {
+				update(stepMs);
+				accumulator -= stepMs;
+				++steps;
+			}
+
+			// too far behind to catch up, drop the backlog rather than spiraling
+			if (steps == maxSteps && accumulator >= stepMs)
+				accumulator = std::fmod(accumulator, stepMs);
+
+			stepsRun = steps;
+			alphaValue = accumulator / stepMs;
+
+			render(alphaValue);
+
+			limit();
+		}
+
+		double step() const noexcept { return stepMs; }
+		double alpha() const noexcept { return alphaValue; }
+		double frameTime() const noexcept { return lastFrameMs; }
+		int stepsLastFrame() const noexcept { return stepsRun; }
+
+	private:
+		void limit() {
+			if (frameMs <= 0.0)
+				return;
+
+			nextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(frameMs));
+
+			auto now = Clock::now();
+			if (nextFrame <= now) {
+				// missed the deadline, start counting again from here instead of bursting frames
+				if (now - nextFrame > std::chrono::duration<double, std::milli>(frameMs))
+					nextFrame = now;
+				return;
+			}
+
+			// SDL_Delay can oversleep by a scheduler tick, so sleep short and spin the rest
+			double remaining = std::chrono::duration<double, std::milli>(nextFrame - now).count();
+			if (remaining > spinMs)
+				SDL_Delay(static_cast<uint32_t>(remaining - spinMs));
+
+			while (Clock::now() < nextFrame) {
+			}
+		}
+
+	private:
+		static constexpr double spinMs = 2.0;
+
+		double stepMs;
+		double frameMs {0.0};
+		int maxSteps;
+		double accumulator {0.0};
+		double alphaValue {0.0};
+		double lastFrameMs {0.0};
+		int stepsRun {0};
+		Clock::time_point last;
+		Clock::time_point nextFrame;
+	};
+} // namespace gmtk
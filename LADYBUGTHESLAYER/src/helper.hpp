@@ -4,14 +4,40 @@
 #include <SDL_image.h>
 #include <SDL_mixer.h>
 #include <SDL_ttf.h>
+#include "shapes.hpp"
 #include <iostream>
+#include <list>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
 
 namespace gmtk {
 	using Texture = std::shared_ptr<SDL_Texture>;
+	using Chunk = std::shared_ptr<Mix_Chunk>;
+
+	/**
+	 * Every loader opens files through openAsset, a mounted archive gets the first look and
+	 * anything it doesn't have is read from disk. The opener may be called from loader threads
+	 */
+	using AssetOpener = SDL_RWops *(*)(std::string_view filePath);
+
+	AssetOpener &assetOpener() {
+		static AssetOpener opener = nullptr;
+		return opener;
+	}
+
+	SDL_RWops *openAsset(std::string_view filePath) {
+		if (assetOpener() != nullptr) {
+			if (SDL_RWops *rw = assetOpener()(filePath))
+				return rw;
+		}
+		return SDL_RWFromFile(std::basic_string<char>(filePath).c_str(), "rb");
+	}
 
 	Texture loadTexture(std::string_view filePath, SDL_Renderer *ren, SDL_Color *key = nullptr) {
-		SDL_Surface *surf = IMG_Load(filePath.data());
+		SDL_Surface *surf = IMG_Load_RW(openAsset(filePath), 1);
 		if (surf == nullptr) {
 			std::cout << "Failed to load path: " << SDL_GetError() << '\n';
 			return nullptr;
@@ -30,16 +56,158 @@ namespace gmtk {
 		return tex;
 	}
 
+	/**
+	 * Hands out shared textures keyed by file path (and color key), so each image is decoded and uploaded once
+	 */
+	class TextureCache {
+	public:
+		Texture load(std::string_view filePath, SDL_Renderer *ren, SDL_Color *key = nullptr) {
+			std::basic_string<char> id = makeKey(filePath, key);
+
+			auto it = textures.find(id);
+			if (it != textures.end()) {
+				++hitCount;
+				return it->second;
+			}
+
+			++missCount;
+			auto tex = loadTexture(filePath, ren, key);
+			if (tex == nullptr)
+				return nullptr;
+
+			byteCount += textureBytes(tex.get());
+			textures.insert({std::move(id), tex});
+
+			return tex;
+		}
+
+		// drops textures that nobody outside of the cache holds anymore
+		void purgeUnused() {
+			for (auto it = textures.begin(); it != textures.end();) {
+				if (it->second.use_count() == 1) {
+					byteCount -= textureBytes(it->second.get());
+					it = textures.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+
+		// must be called before the renderer is destroyed
+		void clear() {
+			textures.clear();
+			byteCount = 0;
+		}
+
+		size_t size() const noexcept { return textures.size(); }
+		size_t hits() const noexcept { return hitCount; }
+		size_t misses() const noexcept { return missCount; }
+		size_t bytes() const noexcept { return byteCount; }
+
+	private:
+		static std::basic_string<char> makeKey(std::string_view filePath, const SDL_Color *key) {
+			std::basic_string<char> id(filePath);
+			if (key != nullptr) {
+				// color keyed variants of the same file are separate textures
+				char suffix[10];
+				SDL_snprintf(suffix, sizeof(suffix), "#%02x%02x%02x%02x", key->r, key->g, key->b, key->a);
+				id += suffix;
+			}
+			return id;
+		}
+
+		static size_t textureBytes(SDL_Texture *tex) {
+			int w, h;
+			SDL_QueryTexture(tex, nullptr, nullptr, &w, &h);
+			return static_cast<size_t>(w) * h * 4;
+		}
+
+	private:
+		std::unordered_map<std::basic_string<char>, Texture> textures;
+		size_t hitCount {0};
+		size_t missCount {0};
+		size_t byteCount {0};
+	};
+
+	/**
+	 * Keeps fonts open per (file, size, outline) so text rendering never goes back to disk
+	 */
+	class FontCache {
+	public:
+		TTF_Font *get(std::string_view fontFile, int fontSize, int outline = 0) {
+			std::basic_string<char> id(fontFile);
+			id += '@' + std::to_string(fontSize) + '@' + std::to_string(outline);
+
+			auto it = fonts.find(id);
+			if (it != fonts.end())
+				return it->second.font.get();
+
+			TTF_Font *font = TTF_OpenFontRW(openAsset(fontFile), 1, fontSize);
+			if (font == nullptr) {
+				std::cout << "TTF_OpenFont error: " << TTF_GetError() << "\n";
+				return nullptr;
+			}
+
+			if (outline > 0)
+				TTF_SetFontOutline(font, outline);
+
+			fonts.insert({std::move(id), Entry {{}, FontPtr(font, TTF_CloseFont)}});
+
+			return font;
+		}
+
+		// opens a font from a file already read into memory, the bytes stay alive as long as the font does
+		TTF_Font *adopt(std::string_view fontFile, int fontSize, int outline, std::vector<char> data) {
+			std::basic_string<char> id(fontFile);
+			id += '@' + std::to_string(fontSize) + '@' + std::to_string(outline);
+
+			auto it = fonts.find(id);
+			if (it != fonts.end())
+				return it->second.font.get();
+
+			TTF_Font *font = TTF_OpenFontRW(SDL_RWFromConstMem(data.data(), static_cast<int>(data.size())), 1, fontSize);
+			if (font == nullptr) {
+				std::cout << "TTF_OpenFontRW error: " << TTF_GetError() << "\n";
+				return nullptr;
+			}
+
+			if (outline > 0)
+				TTF_SetFontOutline(font, outline);
+
+			fonts.insert({std::move(id), Entry {std::move(data), FontPtr(font, TTF_CloseFont)}});
+
+			return font;
+		}
+
+		// must be called before TTF_Quit
+		void clear() { fonts.clear(); }
+
+		size_t size() const noexcept { return fonts.size(); }
+
+	private:
+		using FontPtr = std::unique_ptr<TTF_Font, void (*)(TTF_Font *)>;
+
+		// data is declared first so the font is closed before its bytes go away
+		struct Entry {
+			std::vector<char> data; // empty when opened through openAsset
+			FontPtr font;
+		};
+
+		std::unordered_map<std::basic_string<char>, Entry> fonts;
+	};
+
+	FontCache &fontCache() {
+		static FontCache cache;
+		return cache;
+	}
+
 	Texture loadText(std::string_view msg, SDL_Renderer *ren, std::string_view fontFile, const SDL_Color &col, int fontSize) {
-		TTF_Font *font = TTF_OpenFont(fontFile.data(), fontSize);
-		if (font == nullptr) {
-			std::cout << "TTF_OpenFont error: " << TTF_GetError() << "\n";
+		TTF_Font *font = fontCache().get(fontFile, fontSize);
+		if (font == nullptr)
 			return nullptr;
-		}
 
 		SDL_Surface *surf = TTF_RenderText_Blended(font, msg.data(), col);
 		if (surf == nullptr) {
-			TTF_CloseFont(font);
 			std::cout << "TTF_RenderText error: " << TTF_GetError() << "\n";
 			return nullptr;
 		}
@@ -50,103 +218,132 @@ namespace gmtk {
 		}
 
 		SDL_FreeSurface(surf);
-		TTF_CloseFont(font);
 
 		return tex;
 	}
 
-	Texture loadTextOutline(std::string_view msg, SDL_Renderer *ren, std::string_view fontFile, const SDL_Color &col, int fontSize) {
-		TTF_Font *font = TTF_OpenFont(fontFile.data(), fontSize);
-		if (font == nullptr) {
-			std::cout << "TTF_OpenFont error: " << TTF_GetError() << "\n";
-			return nullptr;
-		}
-
-		TTF_Font *outlineFont = TTF_OpenFont(fontFile.data(), fontSize);
-		if (font == nullptr) {
-			std::cout << "TTF_OpenFont error: " << TTF_GetError() << "\n";
+	// renders msg in col on top of a 1px black outline
+	SDL_Surface *renderTextOutline(std::string_view msg, std::string_view fontFile, const SDL_Color &col, int fontSize) {
+		TTF_Font *font = fontCache().get(fontFile, fontSize);
+		TTF_Font *outlineFont = fontCache().get(fontFile, fontSize, 1);
+		if (font == nullptr || outlineFont == nullptr)
 			return nullptr;
-		}
-
-		TTF_SetFontOutline(outlineFont, 1);
 
 		// background | foreground
 		SDL_Surface *bgSurf = TTF_RenderText_Blended(font, msg.data(), col);
-		SDL_Surface *fgSurf = TTF_RenderText_Blended(outlineFont, msg.data(), {0x00, 0x00, 0x00});
+		SDL_Surface *fgSurf = TTF_RenderText_Blended(outlineFont, msg.data(), {0x00, 0x00, 0x00, 0xFF});
+		if (bgSurf == nullptr || fgSurf == nullptr) {
+			std::cout << "TTF_RenderText error: " << TTF_GetError() << "\n";
+			SDL_FreeSurface(bgSurf);
+			SDL_FreeSurface(fgSurf);
+			return nullptr;
+		}
 
 		// destination rect that gets the size of the surface (explicit x/y for those that want to understand without digging)
 		SDL_Rect position = {position.x = 1, position.y = 1, fgSurf->w, fgSurf->h};
 		SDL_BlitSurface(bgSurf, nullptr, fgSurf, &position);
+		SDL_FreeSurface(bgSurf);
+
+		return fgSurf;
+	}
+
+	Texture loadTextOutline(std::string_view msg, SDL_Renderer *ren, std::string_view fontFile, const SDL_Color &col, int fontSize) {
+		SDL_Surface *surf = renderTextOutline(msg, fontFile, col, fontSize);
+		if (surf == nullptr)
+			return nullptr;
 
-		auto tex = std::shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(ren, fgSurf), SDL_DestroyTexture);
+		auto tex = std::shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(ren, surf), SDL_DestroyTexture);
+		SDL_FreeSurface(surf);
 		if (tex.get() == nullptr) {
 			std::cout << "Text texture failed to be created\n";
 			return nullptr;
 		}
 
-		SDL_FreeSurface(bgSurf);
-		SDL_FreeSurface(fgSurf);
-		TTF_CloseFont(outlineFont);
-		TTF_CloseFont(font);
-
 		return tex;
 	}
 
-	void drawCircle(SDL_Renderer *ren, float x, float y, float radius) {
-		constexpr int tris = 225; // amount of triangles
-		float mirror = 2.0f * static_cast<float>(M_PI); // get the other half of the circle 
-		SDL_Vertex vertices[tris] = {0};
-
-		for (int i = 0; i < tris; i += 3) {
-			// the upper bound of the triangle
-			vertices[i].position.x = x; // 0, 3, 6, 9 
-			vertices[i].position.y = y;
-			vertices[i].color = {255, 255, 255, 255};
-
-			// subtract 3 from tris so we don't operate on a triangle that is out of bounds
-
-			// the lower right bound of the triangle
-			vertices[i + 1].position.x = x + (std::cos(i * mirror / (tris - 3)) * radius); // 1, 4, 7, 10
-			vertices[i + 1].position.y = y + (std::sin(i * mirror / (tris - 3)) * radius);
-			vertices[i + 1].color = {255, 255, 255, 255};
-
-			// the lower left bound of the triangle
-			if (i > 0) {
-				vertices[i - 1].position.x = x + (std::cos(i * mirror / (tris - 3)) * radius); // 2, 5, 8, 11
-				vertices[i - 1].position.y = y + (std::sin(i * mirror / (tris - 3)) * radius);
-				vertices[i - 1].color = {255, 255, 255, 255};
+	/**
+	 * Bounded LRU of rendered strings keyed by (text, font, size, color, outline)
+	 * Evicted textures stay alive for as long as a caller still holds them
+	 */
+	class TextCache {
+	public:
+		TextCache(size_t maxEntries = 256, size_t maxBytes = 16 * 1024 * 1024) : maxEntries(maxEntries), maxBytes(maxBytes) {}
+
+		Texture get(std::string_view msg, SDL_Renderer *ren, std::string_view fontFile, const SDL_Color &col, int fontSize, bool outline = false) {
+			// reuse the same buffer for the lookup key so hits don't allocate
+			scratch.assign(msg);
+			scratch += '\x1f';
+			scratch += fontFile;
+			char suffix[32];
+			SDL_snprintf(suffix, sizeof(suffix), "@%d#%02x%02x%02x%02x%c", fontSize, col.r, col.g, col.b, col.a, outline ? 'o' : 'f');
+			scratch += suffix;
+
+			auto it = index.find(scratch);
+			if (it != index.end()) {
+				++hitCount;
+				entries.splice(entries.begin(), entries, it->second);
+				return it->second->tex;
 			}
-		}
 
-		SDL_RenderGeometry(ren, NULL, vertices, tris - 3, NULL, tris - 3);
-	}
+			++missCount;
+			auto tex = outline ? loadTextOutline(msg, ren, fontFile, col, fontSize) : loadText(msg, ren, fontFile, col, fontSize);
+			if (tex == nullptr)
+				return nullptr;
+
+			int w, h;
+			SDL_QueryTexture(tex.get(), nullptr, nullptr, &w, &h);
 
-	void drawGlow(SDL_Renderer *ren, float x, float y, float radius) {
-		constexpr int tris = 225; // amount of triangles
-		float mirror = 2.0f * static_cast<float>(M_PI); // get the other half of the circle 
-		SDL_Vertex vertices[tris] = {0};
+			entries.push_front({scratch, tex, static_cast<size_t>(w) * h * 4});
+			index.insert({entries.front().key, entries.begin()});
+			byteCount += entries.front().bytes;
 
-		for (int i = 0; i < tris; i += 3) {
-			// the upper bound of the triangle
-			vertices[i].position.x = x; // 0, 3, 6, 9 
-			vertices[i].position.y = y;
-			vertices[i].color = {255, 255, 255, 255};
+			trim();
 
-			// subtract 3 from tris so we don't operate on a triangle that is out of bounds
+			return tex;
+		}
 
-			// the lower right bound of the triangle
-			vertices[i + 1].position.x = x + (std::cos(i * mirror / (tris - 3)) * radius); // 1, 4, 7, 10
-			vertices[i + 1].position.y = y + (std::sin(i * mirror / (tris - 3)) * radius);
+		void clear() {
+			index.clear();
+			entries.clear();
+			byteCount = 0;
+		}
 
-			// the lower left bound of the triangle
-			if (i > 0) {
-				vertices[i - 1].position.x = x + (std::cos(i * mirror / (tris - 3)) * radius); // 2, 5, 8, 11
-				vertices[i - 1].position.y = y + (std::sin(i * mirror / (tris - 3)) * radius);
+		size_t size() const noexcept { return entries.size(); }
+		size_t bytes() const noexcept { return byteCount; }
+		size_t hits() const noexcept { return hitCount; }
+		size_t misses() const noexcept { return missCount; }
+		size_t evictions() const noexcept { return evictCount; }
+
+	private:
+		void trim() {
+			// always keep the newest entry, even if it alone is over budget
+			while (entries.size() > 1 && (entries.size() > maxEntries || byteCount > maxBytes)) {
+				auto &last = entries.back();
+				byteCount -= last.bytes;
+				index.erase(last.key);
+				entries.pop_back();
+				++evictCount;
 			}
 		}
 
-		SDL_RenderGeometry(ren, NULL, vertices, tris - 3, NULL, tris - 3);
-	}
+	private:
+		struct Entry {
+			std::basic_string<char> key;
+			Texture tex;
+			size_t bytes;
+		};
+
+		std::list<Entry> entries;
+		std::unordered_map<std::basic_string<char>, std::list<Entry>::iterator> index;
+		std::basic_string<char> scratch;
+		size_t maxEntries;
+		size_t maxBytes;
+		size_t byteCount {0};
+		size_t hitCount {0};
+		size_t missCount {0};
+		size_t evictCount {0};
+	};
 
 	void drawTexture(SDL_Texture *tex, SDL_Renderer *ren, int x, int y, SDL_Rect *clip = nullptr, double sx = 0.0, double sy = 0.0) noexcept {
 		SDL_Rect dst = {};
@@ -159,7 +356,7 @@ namespace gmtk {
 			SDL_QueryTexture(tex, nullptr, nullptr, &dst.w, &dst.h);
 		}
 
-		if ((sx && sy) != NULL) {
+		if (sx != 0.0 && sy != 0.0) {
 			dst.w *= static_cast<int>(sx);
 			dst.h *= static_cast<int>(sy);
 		}
@@ -181,18 +378,115 @@ namespace gmtk {
 		SDL_RenderCopyEx(ren, tex, clip, &dst, angle, center, flip);
 	}
 
+	/**
+	 * Pre-renders a set of glyphs into a single texture so short labels (dice values, counters)
+	 * can be put together from quads instead of rasterizing a new texture per string
+	 */
+	class GlyphAtlas {
+	public:
+		bool build(SDL_Renderer *ren, std::string_view fontFile, const SDL_Color &col, int fontSize, bool outline, std::string_view charset = "0123456789") {
+			std::vector<SDL_Surface *> surfs;
+			int atlasWidth = 0, atlasHeight = 0;
+
+			for (char c : charset) {
+				char msg[2] = {c, '\0'};
+				SDL_Surface *surf = nullptr;
+				if (outline)
+					surf = renderTextOutline(msg, fontFile, col, fontSize);
+				else if (TTF_Font *font = fontCache().get(fontFile, fontSize))
+					surf = TTF_RenderText_Blended(font, msg, col);
+
+				if (surf == nullptr) {
+					for (auto *i : surfs)
+						SDL_FreeSurface(i);
+					return false;
+				}
+
+				auto &glyph = glyphs[static_cast<uint8_t>(c)];
+				glyph.clip = {atlasWidth, 0, surf->w, surf->h};
+				glyph.valid = true;
+
+				atlasWidth += surf->w;
+				atlasHeight = std::max(atlasHeight, surf->h);
+				surfs.push_back(surf);
+			}
+
+			SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, std::max(atlasWidth, 1), std::max(atlasHeight, 1), 32, SDL_PIXELFORMAT_RGBA32);
+			if (page == nullptr) {
+				std::cout << "Glyph atlas surface failed to be created: " << SDL_GetError() << '\n';
+				for (auto *i : surfs)
+					SDL_FreeSurface(i);
+				return false;
+			}
+
+			for (size_t i = 0; i < surfs.size(); ++i) {
+				SDL_Rect dst = glyphs[static_cast<uint8_t>(charset[i])].clip;
+				// copy the glyph as-is, alpha included
+				SDL_SetSurfaceBlendMode(surfs[i], SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(surfs[i], nullptr, page, &dst);
+				SDL_FreeSurface(surfs[i]);
+			}
+
+			texture = std::shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(ren, page), SDL_DestroyTexture);
+			SDL_FreeSurface(page);
+			if (texture.get() == nullptr) {
+				std::cout << "Glyph atlas texture failed to be created: " << SDL_GetError() << '\n';
+				return false;
+			}
+
+			lineHeight = atlasHeight;
+
+			return true;
+		}
+
+		int measure(std::string_view text) const noexcept {
+			int width = 0;
+			for (char c : text) {
+				const auto &glyph = glyphs[static_cast<uint8_t>(c)];
+				if (glyph.valid)
+					width += glyph.clip.w;
+			}
+			return width;
+		}
+
+		void draw(SDL_Renderer *ren, std::string_view text, int x, int y) {
+			for (char c : text) {
+				auto &glyph = glyphs[static_cast<uint8_t>(c)];
+				if (!glyph.valid)
+					continue;
+
+				drawTexture(texture.get(), ren, x, y, &glyph.clip);
+				x += glyph.clip.w;
+			}
+		}
+
+		int height() const noexcept { return lineHeight; }
+
+	public:
+		Texture texture;
+
+	private:
+		struct Glyph {
+			SDL_Rect clip {0, 0, 0, 0};
+			bool valid {false};
+		};
+
+		Glyph glyphs[256];
+		int lineHeight {0};
+	};
+
 	template <typename T>
 	T *loadSound(std::string_view fileName) {
 		T *sound = nullptr;
 		if constexpr (std::is_same_v<T, Mix_Music>) {
-			sound = Mix_LoadMUS(fileName.data());
+			sound = Mix_LoadMUS_RW(openAsset(fileName), 1);
 			if (sound == nullptr) {
 				std::cout << "Failed to load path\n";
 			} else {
 				std::cout << "Loaded path, preparing music..\n";
 			}
 		} else if constexpr (std::is_same_v<T, Mix_Chunk>) {
-			sound = Mix_LoadWAV(fileName.data());
+			sound = Mix_LoadWAV_RW(openAsset(fileName), 1);
 			if (sound == nullptr) {
 				std::cout << "Failed to load path\n";
 			} else {
@@ -204,16 +498,17 @@ namespace gmtk {
 
 	template <typename T>
 	void playSound(T *sound) noexcept {
+		if (sound == nullptr) {
+			std::cout << "Failed to play, nothing loaded\n";
+			return;
+		}
+
 		if constexpr (std::is_same_v<T, Mix_Music>) {
-			Mix_PlayMusic(sound, 0);
-			if (sound == nullptr) {
-				std::cout << "Failed to play music\n";
-			}
+			if (Mix_PlayMusic(sound, 0) == -1)
+				std::cout << "Failed to play music: " << Mix_GetError() << '\n';
 		} else if constexpr (std::is_same_v<T, Mix_Chunk>) {
-			Mix_PlayChannel(-1, sound, NULL);
-			if (sound == nullptr) {
-				std::cout << "Failed to play chunk\n";
-			}
+			if (Mix_PlayChannel(-1, sound, 0) == -1)
+				std::cout << "Failed to play chunk: " << Mix_GetError() << '\n';
 		}
 	}
 } // namespace gmtk
\ No newline at end of file
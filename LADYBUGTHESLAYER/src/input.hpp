@@ -0,0 +1,224 @@
+#pragma once
+
+#include <SDL.h>
+#include "vector2.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gmtk {
+	// what gameplay asks about; keys and buttons only ever reach it through one of these
+	enum class Action : uint8_t {
+		up,
+		down,
+		left,
+		right,
+		attack,
+		circleAttack,
+		pause,
+		count
+	};
+
+	// one bit per action, a whole tick of input fits in a register
+	using ActionMask = uint64_t;
+	static_assert(static_cast<size_t>(Action::count) <= 64, "actions have to fit an ActionMask");
+
+	constexpr ActionMask actionBit(Action action) noexcept { return ActionMask(1) << static_cast<uint8_t>(action); }
+
+	/**
+	 * Which keys and mouse buttons drive which actions, a mask per scancode and per button so
+	 * translating an event is one load; a key can drive several actions and an action can have several keys
+	 */
+	class InputMap {
+	public:
+		static constexpr int buttonCount = 8;
+
+		InputMap() { defaults(); }
+
+		void bind(Action action, SDL_Scancode key) noexcept {
+			if (key > SDL_SCANCODE_UNKNOWN && key < SDL_NUM_SCANCODES)
+				keys[key] |= actionBit(action);
+		}
+
+		// SDL_BUTTON_LEFT and friends
+		void bindButton(Action action, int button) noexcept {
+			if (button >= 0 && button < buttonCount)
+				buttons[button] |= actionBit(action);
+		}
+
+		void unbind(Action action) noexcept {
+			for (auto &mask : keys)
+				mask &= ~actionBit(action);
+			for (auto &mask : buttons)
+				mask &= ~actionBit(action);
+		}
+
+		// drops every other binding of action, for a rebinding menu
+		void rebind(Action action, SDL_Scancode key) noexcept {
+			unbind(action);
+			bind(action, key);
+		}
+
+		void clear() noexcept {
+			keys.fill(0);
+			buttons.fill(0);
+		}
+
+		// wasd and the arrows to move, mouse to fight
+		void defaults() noexcept {
+			clear();
+			bind(Action::up, SDL_SCANCODE_W);
+			bind(Action::up, SDL_SCANCODE_UP);
+			bind(Action::down, SDL_SCANCODE_S);
+			bind(Action::down, SDL_SCANCODE_DOWN);
+			bind(Action::left, SDL_SCANCODE_A);
+			bind(Action::left, SDL_SCANCODE_LEFT);
+			bind(Action::right, SDL_SCANCODE_D);
+			bind(Action::right, SDL_SCANCODE_RIGHT);
+			bindButton(Action::attack, SDL_BUTTON_LEFT);
+			bindButton(Action::circleAttack, SDL_BUTTON_RIGHT);
+			bind(Action::circleAttack, SDL_SCANCODE_SPACE);
+			bind(Action::pause, SDL_SCANCODE_ESCAPE);
+		}
+
+		ActionMask key(SDL_Scancode key) const noexcept {
+			return key >= 0 && key < SDL_NUM_SCANCODES ? keys[key] : 0;
+		}
+
+		ActionMask button(int button) const noexcept {
+			return button >= 0 && button < buttonCount ? buttons[button] : 0;
+		}
+
+	private:
+		std::array<ActionMask, SDL_NUM_SCANCODES> keys {};
+		std::array<ActionMask, buttonCount> buttons {};
+	};
+
+	/**
+	 * Hand it every event from the poll loop, call tick() at the top of each simulation step, then ask
+	 * about actions; the answers stay the same for the whole step
+	 * Presses and releases are buffered with their timestamps until the next tick, so a click that goes
+	 * down and up between two fixed steps still reads as pressed for one step instead of vanishing
+	 * Steps that run back to back in one frame only see the buffered events once
+	 */
+	class Input {
+	public:
+		struct Event {
+			uint32_t time; // SDL ticks (ms) when it happened
+			Action action;
+			bool down;
+			vec2f mouse; // cursor at that moment, e.g. where a click landed
+		};
+
+		InputMap map;
+
+		void handle(const SDL_Event &ev) {
+			switch (ev.type) {
+				case SDL_KEYDOWN:
+				case SDL_KEYUP:
+					// held keys are already down, os key repeat isn't a new press
+					if (ev.key.repeat == 0)
+						apply(map.key(ev.key.keysym.scancode), ev.type == SDL_KEYDOWN, ev.key.timestamp);
+					break;
+
+				case SDL_MOUSEBUTTONDOWN:
+				case SDL_MOUSEBUTTONUP:
+					cursor = vec2f(static_cast<float>(ev.button.x), static_cast<float>(ev.button.y));
+					apply(map.button(ev.button.button), ev.type == SDL_MOUSEBUTTONDOWN, ev.button.timestamp);
+					break;
+
+				case SDL_MOUSEMOTION:
+					cursor = vec2f(static_cast<float>(ev.motion.x), static_cast<float>(ev.motion.y));
+					break;
+
+				case SDL_WINDOWEVENT:
+					// the key ups go to whoever has focus now, don't leave anything stuck down
+					if (ev.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+						releaseAll(ev.window.timestamp);
+					break;
+			}
+		}
+
+		// takes the snapshot the next step reads; call once per step, before gameplay looks at input
+		void tick() {
+			pressedMask = releasedMask = 0;
+			for (const Event &e : pending)
+				(e.down ? pressedMask : releasedMask) |= actionBit(e.action);
+
+			downMask = held;
+			tickEvents.swap(pending);
+			pending.clear();
+			tickMouse = cursor;
+		}
+
+		// held at the start of this step
+		bool down(Action action) const noexcept { return downMask & actionBit(action); }
+		// went down since the last step, even if it already came back up
+		bool pressed(Action action) const noexcept { return pressedMask & actionBit(action); }
+		bool released(Action action) const noexcept { return releasedMask & actionBit(action); }
+
+		ActionMask downActions() const noexcept { return downMask; }
+
+		// from up / down / left / right, length 1 (or 0), so diagonals aren't faster
+		vec2f movement() const noexcept {
+			vec2f dir(axis(Action::left, Action::right), axis(Action::up, Action::down));
+			if (dir.x != 0.0f && dir.y != 0.0f)
+				dir *= 0.70710678f;
+			return dir;
+		}
+
+		vec2f mouse() const noexcept { return tickMouse; }
+
+		// everything this step picked up, oldest first; for when each click matters, not just that there was one
+		const std::vector<Event> &events() const noexcept { return tickEvents; }
+
+		// lets go of every action, e.g. when the window loses focus or the bindings change
+		void releaseAll(uint32_t time) {
+			for (size_t a = 0; a < holds.size(); ++a) {
+				if (holds[a] > 0)
+					pending.push_back({time, static_cast<Action>(a), false, cursor});
+			}
+			holds.fill(0);
+			held = 0;
+		}
+
+	private:
+		// counts keys per action, so letting go of one of two keys on the same action keeps it held
+		void apply(ActionMask mask, bool isDown, uint32_t time) {
+			for (size_t a = 0; a < holds.size(); ++a) {
+				if ((mask & (ActionMask(1) << a)) == 0)
+					continue;
+
+				if (isDown) {
+					if (holds[a]++ > 0)
+						continue;
+					held |= ActionMask(1) << a;
+				} else {
+					if (holds[a] == 0 || --holds[a] > 0)
+						continue;
+					held &= ~(ActionMask(1) << a);
+				}
+				pending.push_back({time, static_cast<Action>(a), isDown, cursor});
+			}
+		}
+
+		float axis(Action negative, Action positive) const noexcept {
+			return (down(positive) ? 1.0f : 0.0f) - (down(negative) ? 1.0f : 0.0f);
+		}
+
+	private:
+		// live, as events come in
+		std::array<uint8_t, static_cast<size_t>(Action::count)> holds {};
+		ActionMask held {0};
+		vec2f cursor;
+		std::vector<Event> pending;
+
+		// the snapshot for the current step
+		ActionMask downMask {0};
+		ActionMask pressedMask {0};
+		ActionMask releasedMask {0};
+		vec2f tickMouse;
+		std::vector<Event> tickEvents;
+	};
+} // namespace gmtk
@@ -0,0 +1,378 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * A unit of work plus its bookkeeping
+	 * unfinished counts the job itself and every child still running; a job is done once it hits zero
+	 * blockers counts the submit plus every job it still waits on; it's queued once that hits zero
+	 */
+	struct Job {
+		static constexpr size_t storageSize = 64;
+		static constexpr int maxContinuations = 8;
+
+		void (*invoke)(Job &) {nullptr};
+		void (*destroy)(Job &) {nullptr};
+		alignas(std::max_align_t) unsigned char storage[storageSize];
+
+		Job *parent {nullptr};
+		std::atomic<int> unfinished {0};
+		std::atomic<int> blockers {0};
+		std::atomic<int> continuationCount {0};
+		Job *continuations[maxContinuations];
+		std::atomic<bool> retired {false}; // finish() is done with it, the slot may be reused
+
+	};
+
+	/**
+	 * Chase-Lev deque: the owning worker pushes and pops at the bottom, everyone else steals from the top
+	 * Fixed capacity, push fails when full and the caller runs the job itself
+	 */
+	class JobDeque {
+	public:
+		explicit JobDeque(size_t capacity = 4096) : mask(capacity - 1), buffer(capacity) {}
+
+		bool push(Job *job) {
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			if (b - t > static_cast<int64_t>(mask))
+				return false;
+
+			buffer[b & mask].store(job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// owner only
+		Job *pop() {
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b) {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job *job = buffer[b & mask].load(std::memory_order_relaxed);
+			if (t == b) {
+				// last one left, race the thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					job = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job *steal() {
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return nullptr;
+
+			Job *job = buffer[t & mask].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return job;
+		}
+
+	private:
+		// top and bottom on separate lines so thieves don't bounce the owner's cache line
+		alignas(64) std::atomic<int64_t> top {0};
+		alignas(64) std::atomic<int64_t> bottom {0};
+		size_t mask;
+		std::vector<std::atomic<Job *>> buffer;
+	};
+
+	/**
+	 * Work-stealing scheduler, one deque per thread (index 0 is the thread that created it)
+	 * Jobs come out of per-thread rings so scheduling never allocates; a ring slot is reused once its
+	 * job is done and the ring has come back round, so don't keep a Job * around longer than a frame
+	 * Only the creating thread and the workers may create / submit / wait
+	 */
+	class JobSystem {
+	public:
+		static constexpr size_t jobsPerThread = 4096;
+
+		// -1 workers picks one less than the number of cores, 0 runs everything on the calling thread
+		explicit JobSystem(int workerCount = -1) {
+			int n = workerCount >= 0 ? workerCount : std::max(0, SDL_GetCPUCount() - 1);
+
+			for (int i = 0; i <= n; ++i)
+				threads.push_back(std::make_unique<ThreadData>());
+
+			// the creating thread is always 0
+			current() = {this, 0};
+
+			for (int i = 1; i <= n; ++i)
+				workers.emplace_back([this, i] { run(i); });
+		}
+
+		~JobSystem() {
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				stopping.store(true, std::memory_order_release);
+			}
+			wake.notify_all();
+
+			for (auto &worker : workers)
+				worker.join();
+
+			if (current().system == this)
+				current() = {nullptr, 0};
+		}
+
+		JobSystem(const JobSystem &) = delete;
+		JobSystem &operator=(const JobSystem &) = delete;
+
+		// fn must fit in Job::storageSize; capture by reference when it doesn't
+		template <typename F>
+		Job *create(F &&fn, Job *parent = nullptr) {
+			using Fn = std::decay_t<F>;
+			static_assert(sizeof(Fn) <= Job::storageSize, "job lambda too big, capture by reference");
+			static_assert(alignof(Fn) <= alignof(std::max_align_t), "job lambda over aligned");
+
+			Job *job = allocate();
+			new (job->storage) Fn(std::forward<F>(fn));
+			job->invoke = [](Job &j) { (*std::launder(reinterpret_cast<Fn *>(j.storage)))(); };
+			job->destroy = [](Job &j) { std::launder(reinterpret_cast<Fn *>(j.storage))->~Fn(); };
+			job->parent = parent;
+			job->unfinished.store(1, std::memory_order_relaxed);
+			job->blockers.store(1, std::memory_order_relaxed);
+			job->continuationCount.store(0, std::memory_order_relaxed);
+			job->retired.store(false, std::memory_order_relaxed);
+
+			if (parent != nullptr)
+				parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+			return job;
+		}
+
+		// an empty job, useful as a parent to wait on a group
+		Job *group(Job *parent = nullptr) {
+			return create([] {}, parent);
+		}
+
+		/**
+		 * job won't start until before is done
+		 * Call it before either one is submitted; returns false if before already has too many dependents
+		 */
+		bool dependsOn(Job *job, Job *before) {
+			int slot = before->continuationCount.fetch_add(1, std::memory_order_relaxed);
+			if (slot >= Job::maxContinuations) {
+				before->continuationCount.fetch_sub(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			before->continuations[slot] = job;
+			job->blockers.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		void submit(Job *job) { unblock(job); }
+
+		// runs other jobs until job (and every child of it) is done
+		void wait(Job *job) {
+			int self = current().index;
+			while (job->unfinished.load(std::memory_order_acquire) > 0) {
+				if (Job *next = find(self))
+					execute(next);
+				else
+					std::this_thread::yield();
+			}
+		}
+
+		/**
+		 * Splits [0, count) into ranges of at most grain and calls fn(begin, end) on them in parallel
+		 * The returned job finishes once every range has; submit it, then wait on it
+		 */
+		template <typename F>
+		Job *parallelForJob(size_t count, size_t grain, F &fn, Job *parent = nullptr) {
+			Job *root = group(parent);
+			grain = std::max<size_t>(grain, 1);
+
+			for (size_t begin = 0; begin < count; begin += grain) {
+				size_t end = std::min(begin + grain, count);
+				submit(create([&fn, begin, end] { fn(begin, end); }, root));
+			}
+
+			return root;
+		}
+
+		// blocking version, picks a grain that gives every thread a few ranges to balance with
+		template <typename F>
+		void parallelFor(size_t count, F &&fn, size_t minGrain = 256) {
+			if (count == 0)
+				return;
+
+			size_t grain = std::max(minGrain, count / (threadCount() * 4) + 1);
+			if (grain >= count) {
+				fn(size_t {0}, count);
+				return;
+			}
+
+			Job *root = parallelForJob(count, grain, fn);
+			submit(root);
+			wait(root);
+		}
+
+		size_t threadCount() const noexcept { return threads.size(); }
+
+	private:
+		struct ThreadData {
+			JobDeque deque;
+			std::unique_ptr<Job[]> ring {std::make_unique<Job[]>(jobsPerThread)};
+			size_t next {0};
+			uint32_t seed {0x9e3779b9u};
+		};
+
+		struct Current {
+			JobSystem *system;
+			int index;
+		};
+
+		static Current &current() {
+			thread_local Current self {nullptr, 0};
+			return self;
+		}
+
+		Job *allocate() {
+			auto &data = *threads[current().index];
+			// skip past slots whose job is still queued or running, reusing one would corrupt it
+			for (size_t tries = 0; tries < jobsPerThread; ++tries) {
+				Job *job = &data.ring[data.next++ & (jobsPerThread - 1)];
+				if (job->destroy == nullptr)
+					return job;
+				if (!job->retired.load(std::memory_order_acquire))
+					continue;
+
+				job->destroy(*job);
+				job->destroy = nullptr;
+				return job;
+			}
+
+			std::cout << "JobSystem has " << jobsPerThread << " unfinished jobs on one thread, wait on some before creating more\n";
+			std::abort();
+		}
+
+		void unblock(Job *job) {
+			if (job->blockers.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+
+			if (!threads[current().index]->deque.push(job)) {
+				// deque is full, run it here rather than drop it
+				execute(job);
+				return;
+			}
+
+			// a sleeper checks pushes under sleepMutex, taking it here means it either sees this push or gets the notify
+			pushes.fetch_add(1, std::memory_order_seq_cst);
+			if (sleeping.load(std::memory_order_seq_cst) > 0) {
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				wake.notify_one();
+			}
+		}
+
+		Job *find(int self) {
+			if (Job *job = threads[self]->deque.pop())
+				return job;
+
+			size_t n = threads.size();
+			if (n <= 1)
+				return nullptr;
+
+			// start stealing from a random victim so workers don't all hammer the same one
+			uint32_t &seed = threads[self]->seed;
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			size_t first = seed % n;
+			for (size_t i = 0; i < n; ++i) {
+				size_t victim = (first + i) % n;
+				if (victim == static_cast<size_t>(self))
+					continue;
+				if (Job *job = threads[victim]->deque.steal())
+					return job;
+			}
+			return nullptr;
+		}
+
+		void execute(Job *job) {
+			job->invoke(*job);
+			finish(job);
+		}
+
+		void finish(Job *job) {
+			if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+
+			int count = std::min(job->continuationCount.load(std::memory_order_acquire), Job::maxContinuations);
+			for (int i = 0; i < count; ++i)
+				unblock(job->continuations[i]);
+
+			// after this the owner may hand the slot out again, so read parent first
+			Job *parent = job->parent;
+			job->retired.store(true, std::memory_order_release);
+			if (parent != nullptr)
+				finish(parent);
+		}
+
+		void run(int index) {
+			current() = {this, index};
+			threads[index]->seed += static_cast<uint32_t>(index) * 0x85ebca6bu;
+
+			int idle = 0;
+			while (!stopping.load(std::memory_order_acquire)) {
+				// anything pushed after this shows up as a new count, so the sleep below can't miss it
+				uint64_t seen = pushes.load(std::memory_order_seq_cst);
+				if (Job *job = find(index)) {
+					execute(job);
+					idle = 0;
+					continue;
+				}
+
+				// spin a little before sleeping, frames hand out work in bursts
+				if (++idle < 64) {
+					std::this_thread::yield();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				sleeping.fetch_add(1, std::memory_order_seq_cst);
+				// idle until something is pushed, however long that takes
+				wake.wait(lock, [this, seen] {
+					return stopping.load(std::memory_order_acquire) || pushes.load(std::memory_order_seq_cst) != seen;
+				});
+				sleeping.fetch_sub(1, std::memory_order_seq_cst);
+				idle = 0;
+			}
+		}
+
+	private:
+		std::vector<std::unique_ptr<ThreadData>> threads;
+		std::vector<std::thread> workers;
+
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+		std::atomic<int> sleeping {0};
+		std::atomic<uint64_t> pushes {0}; // bumped on every push, what sleeping workers wait to see change
+		std::atomic<bool> stopping {false};
+	};
+} // namespace gmtk
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include "helper.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Single producer / single consumer ring of samples, the fill thread writes and the mixer reads
+	 * Capacity is a power of two so positions can run freely and wrap with a mask
+	 */
+	class SampleRing {
+	public:
+		explicit SampleRing(size_t capacity = 1 << 15) : mask(capacity - 1), samples(capacity) {}
+
+		size_t space() const noexcept { return samples.size() - available(); }
+
+		size_t available() const noexcept {
+			return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+		}
+
+		// producer only, writes up to count samples
+		size_t write(const int16_t *src, size_t count) noexcept {
+			size_t h = head.load(std::memory_order_relaxed);
+			count = std::min(count, samples.size() - (h - tail.load(std::memory_order_acquire)));
+			for (size_t i = 0; i < count; ++i)
+				samples[(h + i) & mask] = src[i];
+			head.store(h + count, std::memory_order_release);
+			return count;
+		}
+
+		// consumer only, reads up to count samples
+		size_t read(int16_t *dst, size_t count) noexcept {
+			size_t t = tail.load(std::memory_order_relaxed);
+			count = std::min(count, head.load(std::memory_order_acquire) - t);
+			for (size_t i = 0; i < count; ++i)
+				dst[i] = samples[(t + i) & mask];
+			tail.store(t + count, std::memory_order_release);
+			return count;
+		}
+
+	private:
+		alignas(64) std::atomic<size_t> head {0};
+		alignas(64) std::atomic<size_t> tail {0};
+		size_t mask;
+		std::vector<int16_t> samples;
+	};
+
+	/**
+	 * Background music through Mix_HookMusic, so it replaces Mix_PlayMusic; open the mixer first
+	 * Tracks are decoded whole on their own thread (ahead of time with prefetch) and kept as pcm, a
+	 * couple of minutes of stereo is tens of MB, so a track is dropped once it has faded out
+	 * A fill thread mixes the playing track and the one fading in into a ring a little ahead of the device
+	 * The mixer callback only copies out of the ring, and nothing here blocks the main thread
+	 * Needs a 16 bit mixer (MIX_DEFAULT_FORMAT), the ring holds interleaved device format samples
+	 */
+	class MusicPlayer {
+	public:
+		// ahead is how much audio (ms) gets mixed before the device asks for it, and so how late a switch is heard
+		explicit MusicPlayer(int ahead = 200) {
+			Uint16 format = 0;
+			if (Mix_QuerySpec(&rate, &format, &channels) == 0) {
+				std::cout << "Music needs the mixer open first: " << Mix_GetError() << '\n';
+				return;
+			}
+			if (format != AUDIO_S16SYS) {
+				std::cout << "Music needs a 16 bit mixer\n";
+				return;
+			}
+
+			// next power of two over the lookahead, in samples
+			size_t want = std::max<size_t>(static_cast<size_t>(rate) * channels * ahead / 1000, 4096);
+			size_t capacity = 1024;
+			while (capacity < want)
+				capacity <<= 1;
+			ring = std::make_unique<SampleRing>(capacity);
+			lookahead = want;
+
+			filler = std::thread([this] { run(); });
+			decoder = std::thread([this] { decode(); });
+			Mix_HookMusic(&MusicPlayer::feed, this);
+		}
+
+		~MusicPlayer() { shutdown(); }
+
+		MusicPlayer(const MusicPlayer &) = delete;
+		MusicPlayer &operator=(const MusicPlayer &) = delete;
+
+		// unhooks from the mixer and stops the threads, call it before the mixer closes
+		void shutdown() {
+			if (!filler.joinable())
+				return;
+
+			Mix_HookMusic(nullptr, nullptr);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			wake.notify_all();
+			decodeWake.notify_all();
+			filler.join();
+			decoder.join();
+		}
+
+		// starts decoding a track now so a later play() of it switches right away
+		void prefetch(std::string_view path) {
+			std::lock_guard<std::mutex> lock(mutex);
+			std::basic_string<char> key(path);
+			if (tracks.count(key) == 0 && std::find(decodeQueue.begin(), decodeQueue.end(), key) == decodeQueue.end())
+				decodeQueue.push_back(std::move(key));
+			decodeWake.notify_one();
+		}
+
+		/**
+		 * Crossfades from whatever is playing to path over fadeMs
+		 * A track that isn't decoded yet starts fading in as soon as it is
+		 */
+		void play(std::string_view path, int fadeMs = 1000, bool loop = true) {
+			prefetch(path);
+			std::lock_guard<std::mutex> lock(mutex);
+			request = {std::basic_string<char>(path), fadeMs, loop, true};
+			wake.notify_one();
+		}
+
+		// fades out to silence
+		void stop(int fadeMs = 1000) {
+			std::lock_guard<std::mutex> lock(mutex);
+			request = {std::basic_string<char>(), fadeMs, false, true};
+			wake.notify_one();
+		}
+
+		// 0..1, applied on top of the fades
+		void setVolume(float v) noexcept { volume.store(std::clamp(v, 0.0f, 1.0f), std::memory_order_relaxed); }
+
+		// drops decoded tracks other than the ones in use or waiting to be faded in
+		void purge() {
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto it = tracks.begin(); it != tracks.end();) {
+				if (it->second.use_count() == 1 && !requested(it->first))
+					it = tracks.erase(it);
+				else
+					++it;
+			}
+		}
+
+		// times the mixer asked for more than the ring had, should stay 0
+		size_t underruns() const noexcept { return underrunCount.load(std::memory_order_relaxed); }
+
+	private:
+		using Track = std::shared_ptr<Mix_Chunk>;
+
+		struct Request {
+			std::basic_string<char> path;
+			int fadeMs {0};
+			bool loop {true};
+			bool fresh {false};
+		};
+
+		struct Voice {
+			Track track;
+			size_t pos {0}; // in samples
+			bool loop {true};
+
+			const int16_t *data() const noexcept { return reinterpret_cast<const int16_t *>(track->abuf); }
+			size_t length() const noexcept { return track->alen / sizeof(int16_t); }
+		};
+
+		// mixer thread, keep it short
+		static void feed(void *udata, Uint8 *stream, int len) {
+			auto *self = static_cast<MusicPlayer *>(udata);
+			auto *out = reinterpret_cast<int16_t *>(stream);
+			size_t want = static_cast<size_t>(len) / sizeof(int16_t);
+
+			size_t got = self->ring->read(out, want);
+			if (got < want) {
+				std::memset(out + got, 0, (want - got) * sizeof(int16_t));
+				if (self->started.load(std::memory_order_relaxed))
+					self->underrunCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			self->wake.notify_one();
+		}
+
+		// fill thread: keeps the ring topped up and starts fades once their track is decoded
+		void run() {
+			std::vector<int16_t> block(1024);
+
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					// the device drains the ring in small steps, top it up at least that often
+					wake.wait_for(lock, std::chrono::milliseconds(5), [this, &block] {
+						return stopping || requestReady() || ring->available() + block.size() <= lookahead;
+					});
+					if (stopping)
+						return;
+
+					takeRequest();
+				}
+
+				fill(block);
+			}
+		}
+
+		// decoder thread: a long decode here never holds up the ring
+		void decode() {
+			for (;;) {
+				std::basic_string<char> path;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					decodeWake.wait(lock, [this] { return stopping || !decodeQueue.empty(); });
+					if (stopping)
+						return;
+
+					path = decodeQueue.front();
+				}
+
+				Track track(Mix_LoadWAV_RW(openAsset(path), 1), Mix_FreeChunk);
+				if (track == nullptr)
+					std::cout << "Failed to load music " << path << ": " << Mix_GetError() << '\n';
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					decodeQueue.pop_front();
+					// failures aren't cached, a later play() of the same path tries the load again
+					if (track != nullptr)
+						tracks[path] = std::move(track);
+					else if (requested(path))
+						request.fresh = false;
+				}
+				wake.notify_one();
+			}
+		}
+
+		// fill thread, lock held; starts the requested fade once its track is ready
+		void takeRequest() {
+			if (!request.fresh)
+				return;
+
+			Track next;
+			if (!request.path.empty()) {
+				auto it = tracks.find(request.path);
+				if (it == tracks.end()) {
+					// still decoding, try again later; if it isn't even queued it was dropped, so decode it again
+					if (std::find(decodeQueue.begin(), decodeQueue.end(), request.path) == decodeQueue.end()) {
+						decodeQueue.push_back(request.path);
+						decodeWake.notify_one();
+					}
+					return;
+				}
+				next = it->second;
+			}
+
+			// a fade still running is cut short, whichever side was louder is what fades out now
+			if (fadeLength > 0 && fadePos * 2 >= fadeLength)
+				std::swap(current, incoming);
+			forget(incoming.track, next);
+
+			incoming = {next, 0, request.loop};
+			fadeLength = std::max<size_t>(static_cast<size_t>(request.fadeMs) * rate / 1000 * channels, 1);
+			fadePos = 0;
+			request.fresh = false;
+		}
+
+		// fill thread; mixes the two voices into the ring until it's lookahead deep
+		void fill(std::vector<int16_t> &block) {
+			while (ring->available() < lookahead) {
+				size_t count = std::min(block.size(), lookahead - ring->available());
+				count -= count % static_cast<size_t>(channels);
+				if (count == 0)
+					break;
+
+				const float master = volume.load(std::memory_order_relaxed);
+				for (size_t i = 0; i < count; i += channels) {
+					// the fade moves a whole frame at a time so channels stay in step
+					float in = fadeLength > 0 ? std::min(static_cast<float>(fadePos) / fadeLength, 1.0f) : 0.0f;
+					float gOut = (1.0f - in) * master, gIn = in * master;
+
+					for (int c = 0; c < channels; ++c) {
+						float s = sample(current) * gOut + sample(incoming) * gIn;
+						block[i + c] = static_cast<int16_t>(std::clamp(s, -32768.0f, 32767.0f));
+					}
+
+					if (fadePos < fadeLength)
+						fadePos += channels;
+				}
+
+				// once the fade is done the incoming voice is the only one left, and the old track can go
+				if (fadeLength > 0 && fadePos >= fadeLength) {
+					Track outgoing = std::move(current.track);
+					current = std::move(incoming);
+					incoming = {};
+					fadeLength = 0;
+
+					std::lock_guard<std::mutex> lock(mutex);
+					forget(outgoing, current.track);
+				}
+
+				ring->write(block.data(), count);
+				started.store(true, std::memory_order_relaxed);
+			}
+		}
+
+		// lock held; a play() waiting on a track that's still decoding shouldn't wake the fill thread
+		bool requestReady() const {
+			return request.fresh && (request.path.empty() || tracks.count(request.path) != 0);
+		}
+
+		// lock held; drops the decoded copy of a track nothing will play, unless it's keep or the pending request
+		void forget(const Track &track, const Track &keep) {
+			if (track == nullptr || track == keep)
+				return;
+
+			for (auto it = tracks.begin(); it != tracks.end(); ++it) {
+				if (it->second == track) {
+					if (!requested(it->first))
+						tracks.erase(it);
+					return;
+				}
+			}
+		}
+
+		// lock held; a play() of path is still waiting to start
+		bool requested(const std::basic_string<char> &path) const {
+			return request.fresh && !request.path.empty() && request.path == path;
+		}
+
+		static float sample(Voice &voice) noexcept {
+			if (voice.track == nullptr)
+				return 0.0f;
+
+			size_t length = voice.length();
+			if (voice.pos >= length) {
+				if (!voice.loop || length == 0)
+					return 0.0f;
+				voice.pos = 0;
+			}
+			return voice.data()[voice.pos++];
+		}
+
+	private:
+		int rate {0};
+		int channels {0};
+		size_t lookahead {0};
+		std::unique_ptr<SampleRing> ring;
+
+		// fill thread only
+		Voice current, incoming;
+		size_t fadeLength {0}, fadePos {0};
+
+		// shared with the main thread, under mutex
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable decodeWake;
+		std::deque<std::basic_string<char>> decodeQueue;
+		std::unordered_map<std::basic_string<char>, Track> tracks;
+		Request request;
+		bool stopping {false};
+
+		std::atomic<float> volume {1.0f};
+		std::atomic<bool> started {false};
+		std::atomic<size_t> underrunCount {0};
+		std::thread filler;
+		std::thread decoder;
+	};
+} // namespace gmtk
@@ -1,11 +1,21 @@
 #include <SDL.h>
+#include "audio.hpp"
+#include "batch.hpp"
+#include "bullets.hpp"
+#include "components.hpp"
+#include "ecs.hpp"
 #include "helper.hpp"
+#include "input.hpp"
+#include "music.hpp"
+#include "particles.hpp"
+#include "random.hpp"
 #include "util.hpp"
 #include "vector2.hpp"
+#include <array>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <chrono>
-#include <random>
 #include <string>
 //#include <unordered_map>
 #include <map>
@@ -21,19 +31,23 @@ namespace gmtk {
 	*/
 
 
-	class Bullet;
 	class Dice;
 
 	namespace lightning {
 		PTR<SDL_Renderer> strike;
+		TextureCache textures;
+		GlyphAtlas diceDigits;
+		SpriteBatch batch;
+		ShapeBatch shapes;
+		Registry registry;
+		SpatialGrid world;
 		// test data below, don't keep here
-		std::vector<std::unique_ptr<Bullet>> bullets;
 		std::vector<std::unique_ptr<Dice>> dices;
 		vec2f mousePos;
+		// seeded in main, pass a seed on the command line to replay a run
+		RandomService random;
 	}
 
-	static std::mt19937_64 gen(std::random_device {}());
-
 	// add user interface
 	// add settings to do the following:
 	// -fullscreen, -volume change (music, chunk)
@@ -52,54 +66,12 @@ namespace gmtk {
 	private:
 	};
 
-	class Animation {
-	public:
-		void addAnimation(std::string_view name, Texture spritesheet, int frames, int x, int y, int w, int h) {
-			for (int i = 0; i < frames; ++i) {
-				SDL_Rect newFrame = {(i + x) * w, y, w, h};
-				this->frames.insert({name.data(), newFrame});
-			}
-
-			this->spritesheet = spritesheet;
-		}
-
-		void update(float speed, double dt) {
-			if (frames.size() > 0) {
-				timeElapsed += static_cast<float>(dt);
-
-				if (timeElapsed >= speed) {
-					timeElapsed = 0.0f;
-					currentFrame = (currentFrame + 1) % static_cast<int>(frames.size());
-				}
-			}
-		}
-
-		uint32_t getFrame(std::string_view frameName) {
-			//uint32_t frameIndex = std::distance(frames.begin(), frames.end(), frames.find(frameName.data()));
-		}
-
-		void setCurrentFrame(std::string_view frameName) {}
-
-	private:
-		Texture spritesheet;
-		float timeElapsed {0.0f};
-		uint32_t currentFrame {0};
-		std::map<std::basic_string<char>, SDL_Rect> frames;
-	};
-
-	class Dice;
-
-	Dice rollSingleDice() {
-
-	}
-
 	// make several instances of these
 	class Dice {
 	public:
 		Dice(int min, int max) : diceMin(min), diceMax(max) {
-			diceSprite = loadTexture("assets/dice.png", lightning::strike.get());
-			//auto dice1 = rollSingleDice();
-			diceText = loadTextOutline(std::to_string(dice1), lightning::strike.get(), "assets/Onest.ttf", {0, 0, 0}, 48);
+			diceSprite = lightning::textures.load("assets/dice.png", lightning::strike.get());
+			roll = rng.range(diceMin, diceMax);
 			SDL_QueryTexture(diceSprite.get(), nullptr, nullptr, &spriteWidth, &spriteHeight);
 			box = {position.x, position.y, (float)spriteWidth, (float)spriteHeight};
 			/*
@@ -109,27 +81,18 @@ namespace gmtk {
 			}
 			*/
 		}
-		// several dice types for modifiers
-		/*
-		int rollSingleDice() {return dice(gen);}
-
-		std::pair<int, int> rollDualDice() {
-			return {dice(gen), dice(gen)};
-		}
-
-		std::tuple<int, int, int> rollTripleDice() {
-			return std::make_tuple(dice(gen), dice(gen), dice(gen));
-		}
-
-		std::tuple<int, int, int, int> rollQuadDice() {
-			return std::make_tuple(dice(gen), dice(gen), dice(gen), dice(gen));
+		// several dice at once for modifiers, auto [a, b] = dice.rollDice<2>();
+		template <size_t N>
+		std::array<int, N> rollDice() {
+			std::array<int, N> rolls;
+			rng.rollN(diceMin, diceMax, N, rolls.data());
+			return rolls;
 		}
-		*/
 
 		void draw(int x, int y) {
 			position = vec2f(x, y);
 			drawTexture(diceSprite.get(), lightning::strike.get(), position.x, position.y);
-			drawTexture(diceText.get(), lightning::strike.get(), box.x, 50);
+			lightning::diceDigits.draw(lightning::strike.get(), std::to_string(roll), box.x, 50);
 		}
 
 		void update(float dt) {
@@ -139,11 +102,11 @@ namespace gmtk {
 
 	private:
 		int diceMin, diceMax;
-		std::uniform_int_distribution<int> dice {diceMin, diceMax};
+		Rng &rng {lightning::random.stream("dice")};
 		Texture diceSprite;
 		vec2f position;
 		SDL_FRect box;
-		Texture diceText;
+		int roll {0};
 		int spriteWidth;
 		int spriteHeight;
 		//std::vector<Texture> diceSpriteList;
@@ -156,27 +119,6 @@ namespace gmtk {
 	private:
 	};
 
-	class Entity {
-	public:
-		virtual void draw() {}
-		virtual void update() {}
-
-		// for clarity
-		void setPosition(vec2f pos) { position = pos; }
-
-		vec2f position;
-
-	protected:
-		std::basic_string<char> name;
-		vec2f velocity;
-		SDL_FRect collisionBox;
-		Animation anim;
-		Texture sprite;
-		int spriteWidth;
-		int spriteHeight;
-		int HP;
-	};
-
 	class Weapon {
 	public:
 		virtual void draw() {}
@@ -194,47 +136,6 @@ namespace gmtk {
 		int spriteHeight;
 	};
 
-	class AI : public Entity {
-	public:
-
-	private:
-	};
-
-	class Wasp;
-	class Dragonfly;
-	class Spider;
-	class Frog;
-
-	class Bullet : public Weapon {
-	public:
-		Bullet() {
-			sprite = loadTexture("assets/particle.png", lightning::strike.get());
-			SDL_QueryTexture(sprite.get(), nullptr, nullptr, &spriteWidth, &spriteHeight);
-			double angle = std::atan2((double)lightning::mousePos.y - position.y, (double)lightning::mousePos.x - position.x);
-			velocity = vec2f(1 * (float)std::cos(angle), 1 * (float)std::sin(angle));
-			collisionBox = {position.x, position.y, (float)spriteWidth, (float)spriteHeight};
-		}
-
-		void draw(int x, int y) {
-			drawTexture(sprite.get(), lightning::strike.get(), x, y);
-		}
-
-		void update(float dt) {
-			position += vec2f(velocity.x, velocity.y);
-			collisionBox.x = position.x;
-			collisionBox.y = position.y;
-		}
-
-	private:
-		friend class Wasp;
-		friend class Dragonfly;
-		friend class Spider;
-		friend class Frog;
-
-	private:
-		float lifetime {0.0f};
-	};
-
 	class Sword : public Weapon {
 	public:
 		Sword() {}
@@ -246,200 +147,252 @@ namespace gmtk {
 		int damage {0};
 	};
 
-	class Ladybug : public Entity {
+	class Ladybug {
 	public:
 		Ladybug() {
-			sprite = loadTexture("assets/warrior.png", lightning::strike.get());
+			sprite = lightning::textures.load("assets/warrior.png", lightning::strike.get());
 			// add animation here
-			UP = SDL_SCANCODE_W;
-			DOWN = SDL_SCANCODE_S;
-			LEFT = SDL_SCANCODE_A;
-			RIGHT = SDL_SCANCODE_D;
 		}
 
 		void draw() {
 			drawTexture(sprite.get(), lightning::strike.get(), position.x, position.y);
 		}
 
-		void update(float dt) {
-			const uint8_t *keystate = SDL_GetKeyboardState(NULL);
-
-			if (keystate[UP]) {
-				if (keystate[LEFT]) {
-					position.x -= 1.0f * dt;
-					position.y -= 1.0f * dt;
-				} else if (keystate[RIGHT]) {
-					position.x += 1.0f * dt;
-					position.y -= 1.0f * dt;
-				} else {
-					position.y -= 1.0f * dt;
-				}
-			}
-
-			if (keystate[DOWN]) {
-				if (keystate[LEFT]) {
-					position.x -= 1.0f * dt;
-					position.y += 1.0f * dt;
-				} else if (keystate[RIGHT]) {
-					position.x += 1.0f * dt;
-					position.y += 1.0f * dt;
-				} else {
-					position.y += 1.0f * dt;
-				}
-			}
+		void update(const Input &input, float dt) {
+			position += input.movement() * dt;
 
-			if (!keystate[UP] && !keystate[DOWN] && !keystate[LEFT] && keystate[RIGHT]) {
-				position.x += 1.0f * dt;
-			}
-
-			if (!keystate[UP] && !keystate[DOWN] && keystate[LEFT] && !keystate[RIGHT]) {
-				position.x -= 1.0f * dt;
-			}
+			if (input.pressed(Action::circleAttack))
+				circleAttack();
 		}
 
 		void attack() {}
 
 		void circleAttack() {}
 
-	private:
-		SDL_Scancode UP, DOWN, LEFT, RIGHT;
-		Sword theChosenOne;
-	};
-
-	class Aphid : public Entity {
-	public:
-		Aphid() {}
-
-		void draw(int x, int y) {}
-		void update(float dt) {}
+		// how far circleAttack will reach, drawn around the ladybug until it's in
+		void drawReach(ShapeBatch &shapes) const {
+			shapes.ring(position.x + 16.0f, position.y + 16.0f, circleReach - 2.0f, circleReach, {255, 80, 80, 120});
+		}
 
-	private:
-	};
+		static constexpr float circleReach = 96.0f;
 
-	class Dragonfly : public Entity {
-	public:
-		Dragonfly() {}
+		// for clarity
+		void setPosition(vec2f pos) { position = pos; }
 
-		void draw(int x, int y) {}
-		void update(float dt) {}
+		vec2f position;
 
 	private:
+		Texture sprite;
+		Sword theChosenOne;
 	};
 
-	class Wasp : public Entity {
-	public:
-		Wasp() {
-			sprite = loadTexture("assets/warrior.png", lightning::strike.get());
-		}
-
-		void draw(int x, int y) {
-			drawTexture(sprite.get(), lightning::strike.get(), x, y);
-		}
-
-		void update(float dt) {}
+	enum class Species : uint8_t {
+		aphid,
+		dragonfly,
+		wasp,
+		spider,
+		frog,
+	};
 
-	private:
+	// tag so systems can pick enemies out from everything else in the registry
+	struct Enemy {
+		Species species;
 	};
 
-	class Spider : public Entity {
-	public:
-		Spider() {}
+	struct SpeciesInfo {
+		const char *sprite; // nullptr until the species has art
+		int hp;
+		float w, h;
+	};
 
-		void draw(int x, int y) {}
-		void update(float dt) {}
+	static const SpeciesInfo speciesInfo[] = {
+		{nullptr, 5, 16.0f, 16.0f}, // aphid
+		{nullptr, 10, 32.0f, 16.0f}, // dragonfly
+		{"assets/warrior.png", 15, 32.0f, 32.0f}, // wasp
+		{nullptr, 20, 32.0f, 32.0f}, // spider
+		{nullptr, 30, 48.0f, 48.0f}, // frog
 	};
 
-	class Frog : public Entity {
-	public:
-		Frog() {}
+	// enemies are plain entities now, what used to be a subclass is a row in speciesInfo
+	static Entity spawnEnemy(Registry &reg, Species species, vec2f pos) {
+		const auto &info = speciesInfo[static_cast<size_t>(species)];
 
-		void draw(int x, int y) {}
-		void update(double dt) {}
+		Entity e = reg.create();
+		reg.emplace<Enemy>(e, species);
+		reg.emplace<Transform>(e, pos.x, pos.y, pos.x, pos.y);
+		reg.emplace<Velocity>(e);
+		reg.emplace<Collider>(e, 0.0f, 0.0f, info.w, info.h);
+		reg.emplace<Health>(e, info.hp, info.hp);
 
-	private:
-	};
+		if (info.sprite != nullptr)
+			reg.emplace<Sprite>(e, lightning::textures.load(info.sprite, lightning::strike.get()));
+
+		return e;
+	}
 
-	static double distanceBetweenEntities(const Entity &e1, const Entity &e2) {
-		double dist = std::abs(std::sqrt(std::pow(e2.position.x - e1.position.x, 2) + std::pow(e2.position.y - e1.position.y, 2)));
-		return dist;
+	static double distanceBetweenEntities(const Transform &e1, const Transform &e2) {
+		double dx = e2.x - e1.x, dy = e2.y - e1.y;
+		return std::sqrt(dx * dx + dy * dy);
 	}
 }
 
 using namespace gmtk;
 
-int main(int, char **)
+int main(int argc, char **argv)
 {
+	lightning::random.reseed(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : freshSeed());
+	std::cout << "seed " << lightning::random.seed() << '\n';
+
 	SDL_assert(SDL_Init(SDL_INIT_EVERYTHING) == 0);
 	SDL_assert(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) != 0);
 	if (TTF_Init() == -1) return false;
+	if (Mix_OpenAudio(48000, MIX_DEFAULT_FORMAT, 2, 1024) == -1)
+		std::cout << "Failed to open audio: " << Mix_GetError() << '\n';
 
 	auto begin = std::chrono::steady_clock::now();
 
 	auto window = PTR<SDL_Window>(SDL_CreateWindow("Ladybug ", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 1024, 768, 0));
 	lightning::strike = PTR<SDL_Renderer>(SDL_CreateRenderer(window.get(), -1, SDL_RENDERER_ACCELERATED));
 
+	lightning::diceDigits.build(lightning::strike.get(), "assets/Onest.ttf", {0, 0, 0}, 48, true);
+
+	auto bulletTex = lightning::textures.load("assets/particle.png", lightning::strike.get());
+	int bulletW = 0, bulletH = 0;
+	SDL_QueryTexture(bulletTex.get(), nullptr, nullptr, &bulletW, &bulletH);
+	BulletPool bullets(1 << 15, (float)bulletW, (float)bulletH);
+	const SDL_FRect arena = {0, 0, 1024, 768};
+	std::vector<Entity> deadScratch;
+
+	// same texture as the bullets, the cache hands back the one already loaded
+	ParticleEffect sparkFx;
+	sparkFx.tex = bulletTex.get();
+	sparkFx.lifeMin = 150.0f;
+	sparkFx.lifeMax = 350.0f;
+	sparkFx.speedMin = 0.1f;
+	sparkFx.speedMax = 0.4f;
+	sparkFx.spread = 1.2f;
+	sparkFx.sizeStart = 6.0f;
+	sparkFx.sizeEnd = 1.0f;
+	sparkFx.colors = {{{0.0f, {255, 255, 200, 255}}, {0.4f, {255, 160, 40, 220}}, {1.0f, {200, 40, 0, 0}}}};
+	sparkFx.colorKeys = 3;
+	ParticlePool sparks(sparkFx, 1 << 14, lightning::random.stream("sparks").next());
+
+	ParticleEffect diceFx;
+	diceFx.tex = bulletTex.get();
+	diceFx.lifeMin = 400.0f;
+	diceFx.lifeMax = 900.0f;
+	diceFx.gravityY = 0.0006f;
+	diceFx.sizeStart = 5.0f;
+	diceFx.sizeEnd = 2.0f;
+	diceFx.colors = {{{0.0f, {120, 200, 255, 255}}, {1.0f, {255, 255, 255, 0}}}};
+	ParticlePool confetti(diceFx, 1 << 12, lightning::random.stream("confetti").next());
+
+	// shots are cheap and capped, the dice roll always gets a channel
+	// assets/shoot.wav and assets/roll.wav aren't in the repo yet, without them these just print a load error and stay silent
+	AudioManager audio(24);
+	SoundId shootSound = audio.load("shoot", "assets/shoot.wav", 0, 6, 0.6f);
+	SoundId rollSound = audio.load("roll", "assets/roll.wav", 10, 1);
+
+	// combat music decodes in the background while the calm track plays, the first shot fades over
+	MusicPlayer music;
+	music.play("assets/calm.ogg", 500);
+	music.prefetch("assets/combat.ogg");
+	bool inCombat = false;
+
 	auto ladybug = std::make_unique<Ladybug>();
 	ladybug->setPosition({100, 100});
-	/*
-	auto diceTex = loadTexture("assets/dice.png", lightning::strike.get());
-
-	auto dice = std::make_unique<Dice>();
-
-	auto [ddice1, ddice2] = dice->rollDualDice();
-	std::cout << ddice1 << ", " << ddice2 << '\n';
-
-	auto [qdice1, qdice2, qdice3, qdice4] = dice->rollQuadDice();
-	std::cout << qdice1 << ", " << qdice2 << ", " << qdice3 << ", " << qdice4 << '\n';
-	*/
 	auto dice = std::make_unique<Dice>(5, 10);
+	confetti.burst(520.0f, 70.0f, 120);
+	audio.play(rollSound);
 
-	auto wasp = std::make_unique<Wasp>();
+	spawnEnemy(lightning::registry, Species::wasp, {100, 100});
 
 	const double FPS = 240.0;
 	const double delay = 1000.0 / FPS;
 
+	Input input;
+
 	SDL_Event ev;
 	bool active = true;
 	while (active) {
 		while (SDL_PollEvent(&ev) != 0) {
+			input.handle(ev);
+
 			switch (ev.type) {
 				case SDL_QUIT:
 					active = false;
 					break;
-
-				case SDL_MOUSEBUTTONDOWN: {
-				case SDL_BUTTON_LEFT: {
-					auto nb = std::make_unique<Bullet>();
-					lightning::bullets.push_back(std::move(nb));
-					std::cout << lightning::bullets.size() << '\n';
-				} break;
-				} break;
-
-				case SDL_MOUSEMOTION:
-					lightning::mousePos = vec2f((float)ev.motion.x, (float)ev.motion.y);
-					break;
 			}
 		}
 		auto end = std::chrono::steady_clock::now();
 		auto dt = std::chrono::duration<double, std::milli>(end - begin);
 		begin = end;
 
-		ladybug->update(static_cast<float>(dt.count()));
+		input.tick();
+		lightning::mousePos = input.mouse();
+
+		// every click since the last frame fires, each toward where it landed
+		for (const auto &click : input.events()) {
+			if (click.action != Action::attack || !click.down)
+				continue;
+
+			bullets.spawn(ladybug->position, click.mouse, 1.0f, 3000.0f);
+			// muzzle sparks sprayed the way the shot went
+			sparks.setDirection(std::atan2(click.mouse.y - ladybug->position.y, click.mouse.x - ladybug->position.x));
+			sparks.burst(ladybug->position.x, ladybug->position.y, 24);
+			audio.play(shootSound);
+			if (!inCombat) {
+				music.play("assets/combat.ogg", 1500);
+				inCombat = true;
+			}
+		}
+
+		ladybug->update(input, static_cast<float>(dt.count()));
+		audio.update();
 		dice->update(static_cast<float>(dt.count()));
-		//wasp->update(static_cast<float>(dt.count()), &ev);
+		storePrevious(lightning::registry);
+		integrate(lightning::registry, static_cast<float>(dt.count()));
+		animate(lightning::registry, static_cast<float>(dt.count()));
+		syncColliders(lightning::registry, lightning::world);
+		bullets.update(static_cast<float>(dt.count()), arena);
+
+		// each shot asks the broadphase what it overlaps and spends itself on the first enemy there
+		bullets.forEach([&](uint32_t slot) {
+			lightning::world.query(bullets.box(slot), [&](SpatialGrid::Proxy id) {
+				if (!bullets.alive(slot))
+					return;
+
+				Entity e = lightning::world.userData(id);
+				auto *health = lightning::registry.tryGet<Health>(e);
+				if (health == nullptr || !lightning::registry.has<Enemy>(e))
+					return;
+
+				--health->hp;
+				bullets.kill(slot);
+			});
+		});
+		reapDead(lightning::registry, &lightning::world, deadScratch);
 
 		SDL_SetRenderDrawColor(lightning::strike.get(), 0, 0, 0, 255);
 		SDL_RenderClear(lightning::strike.get());
 
-		//wasp->draw(100, 100);
+		drawSprites(lightning::registry, lightning::batch);
 
-		for (auto &bullet : lightning::bullets) {
-			bullet->draw(bullet->position.x, bullet->position.y);
-			bullet->update(static_cast<float>(dt.count()));
-		}
+		bullets.draw(lightning::batch, bulletTex.get());
+		lightning::batch.flush(lightning::strike.get());
+
+		sparks.update(static_cast<float>(dt.count()));
+		confetti.update(static_cast<float>(dt.count()));
+		sparks.draw(lightning::strike.get());
+		confetti.draw(lightning::strike.get());
 
 		ladybug->draw();
 
+		// aim glow and attack reach go out together in one geometry call
+		lightning::shapes.glow(lightning::mousePos.x, lightning::mousePos.y, 24.0f, {255, 220, 120, 180});
+		ladybug->drawReach(lightning::shapes);
+		lightning::shapes.flush(lightning::strike.get());
+
 		dice->draw(500, 50);
 
 		SDL_RenderPresent(lightning::strike.get());
@@ -448,6 +401,15 @@ int main(int, char **)
 			SDL_Delay(static_cast<uint32_t>(delay - dt.count()));
 	}
 
+	audio.clear();
+	music.shutdown();
+	Mix_CloseAudio();
+	lightning::registry.clear();
+	lightning::world.clear();
+	bulletTex.reset();
+	lightning::diceDigits.texture.reset();
+	lightning::textures.clear();
+	fontCache().clear();
 	SDL_Quit();
 
 	return 0;
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <SDL.h>
+#include "random.hpp"
+#include "vector2.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define GMTK_PARTICLES_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GMTK_PARTICLES_SSE 1
+#endif
+
+namespace gmtk {
+	/**
+	 * What one kind of particle looks like and how it moves; a pool is built from one of these
+	 * Times are in milliseconds, speeds in pixels per millisecond, angles in radians
+	 */
+	struct ParticleEffect {
+		struct ColorKey {
+			float at; // 0 at birth, 1 at death
+			SDL_Color color;
+		};
+
+		SDL_Texture *tex {nullptr};
+		SDL_Rect clip {0, 0, 0, 0}; // 0 size uses the whole texture
+
+		float lifeMin {300.0f}, lifeMax {600.0f};
+		float speedMin {0.05f}, speedMax {0.2f};
+		float direction {0.0f}; // center of the spray
+		float spread {2.0f * static_cast<float>(M_PI)}; // full width of the spray, a full turn is every way
+		float gravityX {0.0f}, gravityY {0.0f}; // pixels per ms per ms
+
+		float sizeStart {8.0f}, sizeEnd {0.0f};
+
+		// up to four keys, sorted by at; fewer keys hold the last one
+		std::array<ColorKey, 4> colors {{{0.0f, {255, 255, 255, 255}}, {1.0f, {255, 255, 255, 0}}}};
+		int colorKeys {2};
+
+		SDL_BlendMode blend {SDL_BLENDMODE_ADD};
+	};
+
+	/**
+	 * Fixed capacity particles of one effect, one contiguous array per field
+	 * Live particles are packed at the front, a dying one is swapped with the last, so the update and
+	 * the vertex build only ever walk live data and nothing allocates after construction
+	 * Colour and size over life are baked into a table once, drawing is one SDL_RenderGeometry call
+	 */
+	class ParticlePool {
+	public:
+		static constexpr int curveSteps = 64;
+
+		ParticlePool(const ParticleEffect &effect, size_t capacity, uint64_t seed = 0x9e3779b97f4a7c15ull)
+			: fx(effect), cap(capacity), rng(seed) {
+			// pad to a multiple of 8 so the simd loop never needs a remainder
+			size_t padded = (capacity + 7) & ~static_cast<size_t>(7);
+			x.assign(padded, 0.0f);
+			y.assign(padded, 0.0f);
+			vx.assign(padded, 0.0f);
+			vy.assign(padded, 0.0f);
+			age.assign(padded, 0.0f);
+			rate.assign(padded, 0.0f);
+
+			bake();
+
+			vertices.resize(capacity * 4);
+			indices.reserve(capacity * 6);
+			for (size_t i = 0; i < capacity; ++i) {
+				int base = static_cast<int>(i * 4);
+				const int quad[6] = {0, 1, 2, 0, 2, 3};
+				for (int q : quad)
+					indices.push_back(base + q);
+			}
+		}
+
+		// count new particles at (px, py); returns how many fit
+		size_t burst(float px, float py, size_t count) {
+			count = std::min(count, cap - live);
+			const float half = fx.spread * 0.5f;
+
+			for (size_t n = 0; n < count; ++n, ++live) {
+				float angle = fx.direction + rng.uniform(-half, half);
+				float speed = rng.uniform(fx.speedMin, fx.speedMax);
+				x[live] = px;
+				y[live] = py;
+				vx[live] = std::cos(angle) * speed;
+				vy[live] = std::sin(angle) * speed;
+				age[live] = 0.0f;
+				rate[live] = 1.0f / std::max(rng.uniform(fx.lifeMin, fx.lifeMax), 1.0f);
+			}
+
+			return count;
+		}
+
+		// ages, moves and falls every live particle, then packs out the ones that died
+		void update(float dt) {
+			size_t count = (live + 7) & ~static_cast<size_t>(7);
+			const float gx = fx.gravityX * dt, gy = fx.gravityY * dt;
+
+			size_t i = 0;
+#if defined(GMTK_PARTICLES_AVX)
+			const __m256 vdt = _mm256_set1_ps(dt), vgx = _mm256_set1_ps(gx), vgy = _mm256_set1_ps(gy);
+			for (; i < count; i += 8) {
+				__m256 nvx = _mm256_add_ps(_mm256_loadu_ps(&vx[i]), vgx);
+				__m256 nvy = _mm256_add_ps(_mm256_loadu_ps(&vy[i]), vgy);
+				_mm256_storeu_ps(&vx[i], nvx);
+				_mm256_storeu_ps(&vy[i], nvy);
+				_mm256_storeu_ps(&x[i], _mm256_add_ps(_mm256_loadu_ps(&x[i]), _mm256_mul_ps(nvx, vdt)));
+				_mm256_storeu_ps(&y[i], _mm256_add_ps(_mm256_loadu_ps(&y[i]), _mm256_mul_ps(nvy, vdt)));
+				// age is 0..1 over the particle's life, so fading is a table lookup later
+				_mm256_storeu_ps(&age[i], _mm256_add_ps(_mm256_loadu_ps(&age[i]), _mm256_mul_ps(_mm256_loadu_ps(&rate[i]), vdt)));
+			}
+#elif defined(GMTK_PARTICLES_SSE)
+			const __m128 vdt = _mm_set1_ps(dt), vgx = _mm_set1_ps(gx), vgy = _mm_set1_ps(gy);
+			for (; i < count; i += 4) {
+				__m128 nvx = _mm_add_ps(_mm_loadu_ps(&vx[i]), vgx);
+				__m128 nvy = _mm_add_ps(_mm_loadu_ps(&vy[i]), vgy);
+				_mm_storeu_ps(&vx[i], nvx);
+				_mm_storeu_ps(&vy[i], nvy);
+				_mm_storeu_ps(&x[i], _mm_add_ps(_mm_loadu_ps(&x[i]), _mm_mul_ps(nvx, vdt)));
+				_mm_storeu_ps(&y[i], _mm_add_ps(_mm_loadu_ps(&y[i]), _mm_mul_ps(nvy, vdt)));
+				// age is 0..1 over the particle's life, so fading is a table lookup later
+				_mm_storeu_ps(&age[i], _mm_add_ps(_mm_loadu_ps(&age[i]), _mm_mul_ps(_mm_loadu_ps(&rate[i]), vdt)));
+			}
+#endif
+			for (; i < count; ++i) {
+				vx[i] += gx;
+				vy[i] += gy;
+				x[i] += vx[i] * dt;
+				y[i] += vy[i] * dt;
+				age[i] += rate[i] * dt;
+			}
+
+			for (size_t j = 0; j < live;) {
+				if (age[j] < 1.0f) {
+					++j;
+					continue;
+				}
+
+				--live;
+				x[j] = x[live];
+				y[j] = y[live];
+				vx[j] = vx[live];
+				vy[j] = vy[live];
+				age[j] = age[live];
+				rate[j] = rate[live];
+			}
+		}
+
+		void draw(SDL_Renderer *ren) {
+			if (live == 0 || fx.tex == nullptr)
+				return;
+
+			int texW = 0, texH = 0;
+			SDL_QueryTexture(fx.tex, nullptr, nullptr, &texW, &texH);
+			if (texW <= 0 || texH <= 0)
+				return;
+
+			SDL_Rect src = fx.clip;
+			if (src.w == 0 || src.h == 0)
+				src = {0, 0, texW, texH};
+			const float u0 = static_cast<float>(src.x) / texW, v0 = static_cast<float>(src.y) / texH;
+			const float u1 = static_cast<float>(src.x + src.w) / texW, v1 = static_cast<float>(src.y + src.h) / texH;
+
+			SDL_Vertex *v = vertices.data();
+			for (size_t i = 0; i < live; ++i, v += 4) {
+				int step = std::min(static_cast<int>(age[i] * (curveSteps - 1)), curveSteps - 1);
+				const SDL_Color color = colorCurve[step];
+				const float half = sizeCurve[step];
+
+				// centered on the particle, clockwise from top left like SpriteBatch
+				v[0] = {{x[i] - half, y[i] - half}, color, {u0, v0}};
+				v[1] = {{x[i] + half, y[i] - half}, color, {u1, v0}};
+				v[2] = {{x[i] + half, y[i] + half}, color, {u1, v1}};
+				v[3] = {{x[i] - half, y[i] + half}, color, {u0, v1}};
+			}
+
+			SDL_BlendMode previous;
+			SDL_GetTextureBlendMode(fx.tex, &previous);
+			SDL_SetTextureBlendMode(fx.tex, fx.blend);
+			SDL_RenderGeometry(ren, fx.tex, vertices.data(), static_cast<int>(live * 4), indices.data(), static_cast<int>(live * 6));
+			SDL_SetTextureBlendMode(fx.tex, previous);
+		}
+
+		// aims the spray of the next bursts, e.g. along a shot
+		void setDirection(float radians) noexcept { fx.direction = radians; }
+
+		void clear() noexcept { live = 0; }
+
+		size_t size() const noexcept { return live; }
+		size_t capacity() const noexcept { return cap; }
+		const ParticleEffect &effect() const noexcept { return fx; }
+
+	private:
+		void bake() {
+			int keys = std::clamp(fx.colorKeys, 1, static_cast<int>(fx.colors.size()));
+
+			for (int s = 0; s < curveSteps; ++s) {
+				float t = static_cast<float>(s) / (curveSteps - 1);
+				sizeCurve[s] = (fx.sizeStart + (fx.sizeEnd - fx.sizeStart) * t) * 0.5f;
+
+				// find the pair of keys around t, hold the ends
+				SDL_Color c = fx.colors[0].color;
+				if (t >= fx.colors[keys - 1].at) {
+					c = fx.colors[keys - 1].color;
+				} else {
+					for (int k = 0; k + 1 < keys; ++k) {
+						const auto &a = fx.colors[k], &b = fx.colors[k + 1];
+						if (t < a.at || t > b.at)
+							continue;
+
+						float f = b.at > a.at ? (t - a.at) / (b.at - a.at) : 0.0f;
+						auto mix = [f](Uint8 from, Uint8 to) { return static_cast<Uint8>(from + (to - from) * f + 0.5f); };
+						c = {mix(a.color.r, b.color.r), mix(a.color.g, b.color.g), mix(a.color.b, b.color.b), mix(a.color.a, b.color.a)};
+						break;
+					}
+				}
+				colorCurve[s] = c;
+			}
+		}
+
+	private:
+		ParticleEffect fx;
+		size_t cap;
+		size_t live {0};
+		Rng rng;
+
+		std::vector<float> x, y;
+		std::vector<float> vx, vy;
+		std::vector<float> age; // 0..1 of the lifetime, dead at 1
+		std::vector<float> rate; // 1 / lifetime
+
+		std::array<SDL_Color, curveSteps> colorCurve;
+		std::array<float, curveSteps> sizeCurve; // half size
+
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	/**
+	 * Spawns particles into a pool over time: rate per second while running, plus an optional burst
+	 * when started; duration 0 keeps it going until stopped. Emitters are plain values, keep them wherever
+	 */
+	struct ParticleEmitter {
+		vec2f position;
+		float rate {0.0f}; // particles per second
+		float duration {0.0f}; // ms, 0 runs until stopped
+		size_t burst {0}; // fired once on the first update
+
+		bool active {true};
+		float elapsed {0.0f};
+		float owed {0.0f}; // fraction of a particle carried between ticks
+		bool burstDone {false};
+
+		void update(ParticlePool &pool, float dt) {
+			if (!active)
+				return;
+
+			if (!burstDone) {
+				pool.burst(position.x, position.y, burst);
+				burstDone = true;
+			}
+
+			owed += rate * dt * 0.001f;
+			if (owed >= 1.0f) {
+				size_t count = static_cast<size_t>(owed);
+				pool.burst(position.x, position.y, count);
+				owed -= static_cast<float>(count);
+			}
+
+			elapsed += dt;
+			if (duration > 0.0f && elapsed >= duration)
+				active = false;
+		}
+
+		void restart() noexcept {
+			active = true;
+			elapsed = 0.0f;
+			owed = 0.0f;
+			burstDone = false;
+		}
+	};
+} // namespace gmtk
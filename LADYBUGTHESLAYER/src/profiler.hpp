@@ -0,0 +1,287 @@
+#pragma once
+
+#include <SDL.h>
+#include "helper.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define GMTK_CONCAT_INNER(a, b) a##b
+#define GMTK_CONCAT(a, b) GMTK_CONCAT_INNER(a, b)
+// zone names must be string literals, only the pointer gets stored
+#define GMTK_PROFILE(name) gmtk::ProfileZone GMTK_CONCAT(profileZone, __LINE__)(name)
+
+namespace gmtk {
+	struct ProfileEvent {
+		const char *name;
+		int64_t start; // ns since the profiler started
+		int64_t end;
+		uint32_t frame;
+	};
+
+	/**
+	 * Fixed size ring of finished zones, one per thread
+	 * The lock is only ever contended while a trace is being dumped
+	 */
+	class ProfileBuffer {
+	public:
+		ProfileBuffer(uint32_t threadId, size_t capacity) : threadId(threadId), events(capacity) {}
+
+		void push(const ProfileEvent &ev) {
+			std::lock_guard<std::mutex> lock(mutex);
+			events[head] = ev;
+			head = (head + 1) % events.size();
+			count = std::min(count + 1, events.size());
+		}
+
+		// calls fn(event) oldest first
+		template <typename F>
+		void forEach(F &&fn) {
+			std::lock_guard<std::mutex> lock(mutex);
+			size_t first = (head + events.size() - count) % events.size();
+			for (size_t i = 0; i < count; ++i)
+				fn(events[(first + i) % events.size()]);
+		}
+
+		const uint32_t threadId;
+
+	private:
+		std::mutex mutex;
+		std::vector<ProfileEvent> events;
+		size_t head {0};
+		size_t count {0};
+	};
+
+	class Profiler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static Profiler &get() {
+			static Profiler profiler;
+			return profiler;
+		}
+
+		int64_t now() const noexcept {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+		}
+
+		ProfileBuffer &threadBuffer() {
+			thread_local ProfileBuffer *buffer = nullptr;
+			if (buffer == nullptr) {
+				std::lock_guard<std::mutex> lock(mutex);
+				buffers.push_back(std::make_unique<ProfileBuffer>(static_cast<uint32_t>(buffers.size()), eventsPerThread));
+				buffer = buffers.back().get();
+			}
+			return *buffer;
+		}
+
+		void record(const char *name, int64_t start, int64_t end) {
+			threadBuffer().push({name, start, end, currentFrame});
+
+			// per frame totals are only kept for the main (first) thread
+			if (threadBuffer().threadId != 0)
+				return;
+
+			for (auto &zone : zones) {
+				if (sameName(zone.name, name)) {
+					zone.current += end - start;
+					return;
+				}
+			}
+			zones.push_back({name, end - start, 0});
+		}
+
+		// called once per frame on the main thread, closes the previous frame
+		void endFrame() {
+			int64_t t = now();
+			if (frameStart != 0) {
+				frameTimes[frameHead] = static_cast<float>((t - frameStart) / 1.0e6);
+				frameHead = (frameHead + 1) % frameTimes.size();
+				frameCount = std::min(frameCount + 1, frameTimes.size());
+			}
+			frameStart = t;
+
+			for (auto &zone : zones) {
+				zone.last = zone.current;
+				zone.current = 0;
+			}
+
+			++currentFrame;
+		}
+
+		// total time spent in zones called name during the last finished frame
+		double zoneMs(const char *name) const noexcept {
+			for (const auto &zone : zones) {
+				if (sameName(zone.name, name))
+					return zone.last / 1.0e6;
+			}
+			return 0.0;
+		}
+
+		// p in [0, 1] over the recent frame history
+		double percentile(double p) {
+			if (frameCount == 0)
+				return 0.0;
+
+			sorted.assign(frameTimes.begin(), frameTimes.begin() + frameCount);
+			size_t n = std::min(static_cast<size_t>(p * (frameCount - 1) + 0.5), frameCount - 1);
+			std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+			return sorted[n];
+		}
+
+		void setCounter(const char *name, int64_t value) {
+			for (auto &counter : counters) {
+				if (sameName(counter.first, name)) {
+					counter.second = value;
+					return;
+				}
+			}
+			counters.push_back({name, value});
+		}
+
+		int64_t counter(const char *name) const noexcept {
+			for (const auto &counter : counters) {
+				if (sameName(counter.first, name))
+					return counter.second;
+			}
+			return 0;
+		}
+
+		// writes every buffered zone as a chrome://tracing (or Perfetto) json file
+		bool dumpChromeTrace(std::string_view filePath) {
+			FILE *file = std::fopen(std::basic_string<char>(filePath).c_str(), "w");
+			if (file == nullptr) {
+				std::cout << "Failed to open trace file: " << filePath << '\n';
+				return false;
+			}
+
+			std::fputs("{\"traceEvents\":[\n", file);
+			bool first = true;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto &buffer : buffers) {
+				buffer->forEach([&](const ProfileEvent &ev) {
+					std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+						first ? "" : ",\n", ev.name, buffer->threadId, ev.start / 1000.0, (ev.end - ev.start) / 1000.0, ev.frame);
+					first = false;
+				});
+			}
+
+			std::fputs("\n]}\n", file);
+			std::fclose(file);
+
+			return true;
+		}
+
+	private:
+		Profiler() : epoch(Clock::now()), frameTimes(240, 0.0f) {}
+
+		// identical literals usually share a pointer, but that isn't guaranteed across translation units
+		static bool sameName(const char *a, const char *b) noexcept {
+			return a == b || std::strcmp(a, b) == 0;
+		}
+
+		struct Zone {
+			const char *name;
+			int64_t current;
+			int64_t last;
+		};
+
+		static constexpr size_t eventsPerThread = 1 << 16;
+
+		Clock::time_point epoch;
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+		std::vector<Zone> zones;
+		std::vector<std::pair<const char *, int64_t>> counters;
+		std::vector<float> frameTimes;
+		std::vector<float> sorted;
+		size_t frameHead {0};
+		size_t frameCount {0};
+		int64_t frameStart {0};
+		uint32_t currentFrame {0};
+	};
+
+	class ProfileZone {
+	public:
+		explicit ProfileZone(const char *name) : name(name), start(Profiler::get().now()) {}
+		~ProfileZone() { Profiler::get().record(name, start, Profiler::get().now()); }
+
+		ProfileZone(const ProfileZone &) = delete;
+		ProfileZone &operator=(const ProfileZone &) = delete;
+
+	private:
+		const char *name;
+		int64_t start;
+	};
+
+	/**
+	 * Frame timing readout drawn with loadText through a TextCache
+	 * The text only changes a few times a second so the cache isn't churned every frame
+	 */
+	class ProfilerOverlay {
+	public:
+		ProfilerOverlay(std::string_view fontFile = "assets/Onest.ttf", int fontSize = 16) : fontFile(fontFile), fontSize(fontSize) {}
+
+		void draw(SDL_Renderer *ren, int x = 8, int y = 8) {
+			if (!visible)
+				return;
+
+			auto &profiler = Profiler::get();
+
+			int64_t t = profiler.now();
+			if (t - lastRefresh > refreshNs || lines.empty()) {
+				lastRefresh = t;
+				refresh(profiler);
+			}
+
+			for (const auto &line : lines) {
+				auto tex = text.get(line, ren, fontFile, {255, 255, 255, 255}, fontSize, true);
+				if (tex == nullptr)
+					continue;
+
+				drawTexture(tex.get(), ren, x, y);
+				y += fontSize + 4;
+			}
+		}
+
+		// must be called before the renderer is destroyed
+		void clear() { text.clear(); }
+
+		bool visible {true};
+
+	private:
+		void refresh(Profiler &profiler) {
+			char buf[96];
+			lines.clear();
+
+			SDL_snprintf(buf, sizeof(buf), "update %.2f ms  render %.2f ms  present %.2f ms",
+				profiler.zoneMs("update"), profiler.zoneMs("render"), profiler.zoneMs("present"));
+			lines.push_back(buf);
+
+			SDL_snprintf(buf, sizeof(buf), "frame p50 %.2f  p95 %.2f  p99 %.2f ms",
+				profiler.percentile(0.5), profiler.percentile(0.95), profiler.percentile(0.99));
+			lines.push_back(buf);
+
+			SDL_snprintf(buf, sizeof(buf), "draw calls %lld  sprites %lld",
+				static_cast<long long>(profiler.counter("draw calls")), static_cast<long long>(profiler.counter("sprites")));
+			lines.push_back(buf);
+		}
+
+	private:
+		static constexpr int64_t refreshNs = 250'000'000;
+
+		std::basic_string<char> fontFile;
+		int fontSize;
+		TextCache text {32};
+		std::vector<std::basic_string<char>> lines;
+		int64_t lastRefresh {0};
+	};
+} // namespace gmtk
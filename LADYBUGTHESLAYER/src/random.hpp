@@ -0,0 +1,305 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GMTK_RANDOM_AVX2 1
+#endif
+
+namespace gmtk {
+	// splitmix64, turns any seed (even 0) into well mixed state words
+	inline uint64_t splitmix(uint64_t &x) noexcept {
+		uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	/**
+	 * xoshiro256++: 32 bytes of state, a handful of adds / shifts per number
+	 * Meets the standard bit generator requirements, so std distributions still work on it
+	 * Same seed, same sequence on every platform and build, so a run can be replayed
+	 */
+	class Rng {
+	public:
+		using result_type = uint64_t;
+
+		explicit Rng(uint64_t seed = 0x853c49e6748fea9bull) { reseed(seed); }
+
+		void reseed(uint64_t seed) noexcept {
+			uint64_t x = seed;
+			for (auto &word : s)
+				word = splitmix(x);
+		}
+
+		static constexpr result_type min() noexcept { return 0; }
+		static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+		result_type operator()() noexcept { return next(); }
+
+		uint64_t next() noexcept {
+			const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+			const uint64_t t = s[1] << 17;
+
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = rotl(s[3], 45);
+
+			return result;
+		}
+
+		/**
+		 * Unbiased number in [0, bound) by multiply and shift (Lemire)
+		 * Only draws again on the rare low product that would favour some values; never divides on the common path
+		 */
+		uint32_t below(uint32_t bound) noexcept {
+			if (bound == 0)
+				return 0;
+
+			uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+			uint32_t low = static_cast<uint32_t>(m);
+			if (low < bound) {
+				const uint32_t threshold = (0u - bound) % bound;
+				while (low < threshold) {
+					m = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+					low = static_cast<uint32_t>(m);
+				}
+			}
+			return static_cast<uint32_t>(m >> 32);
+		}
+
+		// inclusive on both ends, like a die
+		int range(int lo, int hi) noexcept {
+			if (hi < lo)
+				std::swap(lo, hi);
+
+			uint32_t span = static_cast<uint32_t>(static_cast<int64_t>(hi) - lo + 1);
+			// span wrapped to 0: every int is fair game
+			if (span == 0)
+				return static_cast<int>(static_cast<uint32_t>(next() >> 32));
+			return static_cast<int>(static_cast<int64_t>(lo) + below(span));
+		}
+
+		// [0, 1), 24 random bits so every value is exactly representable
+		float uniform() noexcept { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+
+		float uniform(float lo, float hi) noexcept { return lo + (hi - lo) * uniform(); }
+
+		bool chance(float p) noexcept { return uniform() < p; }
+
+		/**
+		 * count rolls in [lo, hi] into out, same numbers as every other build for the same state
+		 * From 16 rolls up, four generators run side by side so the loop vectorizes; they're seeded
+		 * off this stream, which then moves on by four draws (plus any redraws) however many were rolled
+		 */
+		void rollN(int lo, int hi, size_t count, int *out) noexcept;
+
+		/**
+		 * Skips 2^128 numbers ahead; the skipped stretch is handed back as its own stream
+		 * Streams made this way never overlap, however many are split off
+		 */
+		Rng split() noexcept {
+			Rng child = *this;
+			jump();
+			return child;
+		}
+
+		void jump() noexcept {
+			static constexpr uint64_t poly[4] = {0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull};
+
+			uint64_t t[4] = {0, 0, 0, 0};
+			for (uint64_t word : poly) {
+				for (int b = 0; b < 64; ++b) {
+					if (word & (1ull << b)) {
+						t[0] ^= s[0];
+						t[1] ^= s[1];
+						t[2] ^= s[2];
+						t[3] ^= s[3];
+					}
+					next();
+				}
+			}
+
+			s[0] = t[0];
+			s[1] = t[1];
+			s[2] = t[2];
+			s[3] = t[3];
+		}
+
+		bool operator==(const Rng &other) const noexcept {
+			return s[0] == other.s[0] && s[1] == other.s[1] && s[2] == other.s[2] && s[3] == other.s[3];
+		}
+
+		bool operator!=(const Rng &other) const noexcept { return !(*this == other); }
+
+	private:
+		static constexpr uint64_t rotl(uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+		uint64_t s[4];
+	};
+
+	inline void Rng::rollN(int lo, int hi, size_t count, int *out) noexcept {
+		if (hi < lo)
+			std::swap(lo, hi);
+
+		const uint32_t span = static_cast<uint32_t>(static_cast<int64_t>(hi) - lo + 1);
+		// a handful of dice isn't worth seeding lanes for
+		if (span == 0 || count < 16) {
+			for (size_t i = 0; i < count; ++i)
+				out[i] = range(lo, hi);
+			return;
+		}
+
+		// four lanes, one state word per array so lane k of every word sits side by side
+		alignas(32) uint64_t s0[4], s1[4], s2[4], s3[4];
+		for (int k = 0; k < 4; ++k) {
+			uint64_t x = next();
+			s0[k] = splitmix(x);
+			s1[k] = splitmix(x);
+			s2[k] = splitmix(x);
+			s3[k] = splitmix(x);
+		}
+
+		// products whose low half lands under this would bias the result, those get redrawn
+		const uint32_t threshold = (0u - span) % span;
+
+		// every step gives 4 numbers of 64 bits, each split into two 32 bit draws: 8 rolls
+		alignas(32) uint32_t value[8], low[8];
+		size_t i = 0;
+
+#if defined(GMTK_RANDOM_AVX2)
+		__m256i v0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(s0));
+		__m256i v1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(s1));
+		__m256i v2 = _mm256_load_si256(reinterpret_cast<const __m256i *>(s2));
+		__m256i v3 = _mm256_load_si256(reinterpret_cast<const __m256i *>(s3));
+		const __m256i vspan = _mm256_set1_epi64x(span);
+		const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+		const __m256i vthreshold = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(threshold)), sign);
+		const __m256i vlo = _mm256_set1_epi32(lo);
+
+		for (; i + 8 <= count; i += 8) {
+			__m256i sum = _mm256_add_epi64(v0, v3);
+			__m256i x = _mm256_add_epi64(_mm256_or_si256(_mm256_slli_epi64(sum, 23), _mm256_srli_epi64(sum, 41)), v0);
+			__m256i t = _mm256_slli_epi64(v1, 17);
+			v2 = _mm256_xor_si256(v2, v0);
+			v3 = _mm256_xor_si256(v3, v1);
+			v1 = _mm256_xor_si256(v1, v2);
+			v0 = _mm256_xor_si256(v0, v3);
+			v2 = _mm256_xor_si256(v2, t);
+			v3 = _mm256_or_si256(_mm256_slli_epi64(v3, 45), _mm256_srli_epi64(v3, 19));
+
+			// low and high halves times span; the high 32 bits of each product is the roll
+			__m256i mLow = _mm256_mul_epu32(x, vspan);
+			__m256i mHigh = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), vspan);
+			__m256i rolls = _mm256_blend_epi32(_mm256_srli_epi64(mLow, 32), mHigh, 0xaa);
+			__m256i fractions = _mm256_blend_epi32(mLow, _mm256_slli_epi64(mHigh, 32), 0xaa);
+
+			// unsigned fractions < threshold, done as signed by flipping the top bit
+			__m256i biased = _mm256_cmpgt_epi32(vthreshold, _mm256_xor_si256(fractions, sign));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi32(rolls, vlo));
+
+			if (!_mm256_testz_si256(biased, biased)) {
+				int mask = _mm256_movemask_ps(_mm256_castsi256_ps(biased));
+				for (int j = 0; j < 8; ++j) {
+					if (mask & (1 << j))
+						out[i + j] = static_cast<int>(static_cast<int64_t>(lo) + below(span));
+				}
+			}
+		}
+
+		_mm256_store_si256(reinterpret_cast<__m256i *>(s0), v0);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(s1), v1);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(s2), v2);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(s3), v3);
+#endif
+
+		// scalar lanes, the same math and order as the simd loop so both give identical rolls
+		for (; i < count; i += 8) {
+			for (int k = 0; k < 4; ++k) {
+				const uint64_t x = rotl(s0[k] + s3[k], 23) + s0[k];
+				const uint64_t t = s1[k] << 17;
+				s2[k] ^= s0[k];
+				s3[k] ^= s1[k];
+				s1[k] ^= s2[k];
+				s0[k] ^= s3[k];
+				s2[k] ^= t;
+				s3[k] = rotl(s3[k], 45);
+
+				const uint64_t mLow = (x & 0xffffffffull) * span;
+				const uint64_t mHigh = (x >> 32) * span;
+				value[k * 2] = static_cast<uint32_t>(mLow >> 32);
+				low[k * 2] = static_cast<uint32_t>(mLow);
+				value[k * 2 + 1] = static_cast<uint32_t>(mHigh >> 32);
+				low[k * 2 + 1] = static_cast<uint32_t>(mHigh);
+			}
+
+			size_t n = count - i < 8 ? count - i : 8;
+			for (size_t j = 0; j < n; ++j) {
+				out[i + j] = static_cast<int>(static_cast<int64_t>(lo) + value[j]);
+				if (low[j] < threshold)
+					out[i + j] = static_cast<int>(static_cast<int64_t>(lo) + below(span));
+			}
+		}
+	}
+
+	// a seed that differs every launch, for when no replay seed was given
+	inline uint64_t freshSeed() {
+		std::random_device rd;
+		uint64_t seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+		return seed ^ SDL_GetPerformanceCounter();
+	}
+
+	/**
+	 * One master seed, one named stream per system (dice, loot, ai...)
+	 * A stream only depends on the master seed and its own name, so adding a system or rolling
+	 * more in one of them never shifts what the others get
+	 */
+	class RandomService {
+	public:
+		explicit RandomService(uint64_t seed = 0) : masterSeed(seed) {}
+
+		// restarts every stream from a new master seed
+		void reseed(uint64_t seed) {
+			masterSeed = seed;
+			for (auto &[name, rng] : streams)
+				rng.reseed(streamSeed(name));
+		}
+
+		// references stay valid for as long as the service does
+		Rng &stream(const std::basic_string<char> &name) {
+			auto it = streams.find(name);
+			if (it == streams.end())
+				it = streams.emplace(name, Rng(streamSeed(name))).first;
+			return it->second;
+		}
+
+		uint64_t seed() const noexcept { return masterSeed; }
+
+	private:
+		uint64_t streamSeed(const std::basic_string<char> &name) const noexcept {
+			// fnv-1a over the name, mixed with the master seed
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for (unsigned char c : name) {
+				hash ^= c;
+				hash *= 0x100000001b3ull;
+			}
+			uint64_t x = masterSeed ^ hash;
+			return splitmix(x);
+		}
+
+	private:
+		uint64_t masterSeed;
+		std::unordered_map<std::basic_string<char>, Rng> streams;
+	};
+} // namespace gmtk
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Unit circle points and index patterns for a fixed set of segment counts, built once
+	 * Shapes scale and offset these instead of calling sin / cos per vertex
+	 */
+	class CircleMeshes {
+	public:
+		static constexpr int levels = 8;
+		static constexpr std::array<int, levels> segmentCounts = {8, 12, 16, 24, 32, 48, 64, 128};
+
+		struct Mesh {
+			int segments;
+			std::vector<SDL_FPoint> unit; // segments points, counter clockwise from +x
+			std::vector<int> fan; // center is 0, rim is 1..segments
+			std::vector<int> ring; // inner rim 0..segments-1, outer rim segments..2*segments-1
+		};
+
+		CircleMeshes() {
+			for (int l = 0; l < levels; ++l) {
+				Mesh &mesh = meshes[l];
+				const int n = segmentCounts[l];
+				mesh.segments = n;
+				mesh.unit.resize(n);
+				for (int i = 0; i < n; ++i) {
+					double a = 2.0 * M_PI * i / n;
+					mesh.unit[i] = {static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a))};
+				}
+
+				mesh.fan.reserve(n * 3);
+				mesh.ring.reserve(n * 6);
+				for (int i = 0; i < n; ++i) {
+					int next = (i + 1) % n;
+					mesh.fan.insert(mesh.fan.end(), {0, 1 + i, 1 + next});
+					mesh.ring.insert(mesh.ring.end(), {i, n + i, n + next, i, n + next, next});
+				}
+			}
+		}
+
+		/**
+		 * Level whose chords stay within tolerance pixels of a circle this big on screen
+		 * A chord over angle t sags r * (1 - cos(t / 2)) from the arc, so small circles get few segments
+		 */
+		static int levelFor(float radius, float tolerance = 0.35f) noexcept {
+			if (radius <= tolerance)
+				return 0;
+
+			float needed = static_cast<float>(M_PI) / std::acos(std::max(1.0f - tolerance / radius, -1.0f));
+			for (int l = 0; l < levels; ++l) {
+				if (segmentCounts[l] >= needed)
+					return l;
+			}
+			return levels - 1;
+		}
+
+		const Mesh &mesh(int level) const noexcept { return meshes[std::clamp(level, 0, levels - 1)]; }
+		const Mesh &forRadius(float radius) const noexcept { return meshes[levelFor(radius)]; }
+
+	private:
+		std::array<Mesh, levels> meshes;
+	};
+
+	inline const CircleMeshes &circleMeshes() {
+		static const CircleMeshes meshes;
+		return meshes;
+	}
+
+	/**
+	 * Collects untextured circles, rings, arcs and glows over a frame and submits them in one
+	 * SDL_RenderGeometry call; coordinates and radii are in screen pixels, which picks the detail
+	 */
+	class ShapeBatch {
+	public:
+		struct Stats {
+			size_t shapes {0};
+			size_t vertices {0};
+			size_t drawCalls {0};
+		};
+
+		void circle(float x, float y, float radius, SDL_Color color) {
+			if (radius <= 0.0f)
+				return;
+
+			const auto &mesh = circleMeshes().forRadius(radius);
+			int base = static_cast<int>(vertices.size());
+			vertices.push_back({{x, y}, color, {0.0f, 0.0f}});
+			for (const auto &p : mesh.unit)
+				vertices.push_back({{x + p.x * radius, y + p.y * radius}, color, {0.0f, 0.0f}});
+			append(mesh.fan, base);
+		}
+
+		// solid at the center, fading to fully transparent at the rim
+		void glow(float x, float y, float radius, SDL_Color color) {
+			if (radius <= 0.0f)
+				return;
+
+			SDL_Color edge = color;
+			edge.a = 0;
+
+			const auto &mesh = circleMeshes().forRadius(radius);
+			int base = static_cast<int>(vertices.size());
+			vertices.push_back({{x, y}, color, {0.0f, 0.0f}});
+			for (const auto &p : mesh.unit)
+				vertices.push_back({{x + p.x * radius, y + p.y * radius}, edge, {0.0f, 0.0f}});
+			append(mesh.fan, base);
+		}
+
+		// band between inner and outer, e.g. an area of effect outline
+		void ring(float x, float y, float inner, float outer, SDL_Color color) {
+			if (outer <= 0.0f || inner >= outer)
+				return;
+			if (inner <= 0.0f) {
+				circle(x, y, outer, color);
+				return;
+			}
+
+			const auto &mesh = circleMeshes().forRadius(outer);
+			int base = static_cast<int>(vertices.size());
+			for (const auto &p : mesh.unit)
+				vertices.push_back({{x + p.x * inner, y + p.y * inner}, color, {0.0f, 0.0f}});
+			for (const auto &p : mesh.unit)
+				vertices.push_back({{x + p.x * outer, y + p.y * outer}, color, {0.0f, 0.0f}});
+			append(mesh.ring, base);
+		}
+
+		/**
+		 * Part of a ring from start, sweeping clockwise on screen by sweep (both in radians)
+		 * inner 0 gives a pie slice; the two end angles are exact, the steps in between follow the
+		 * detail of a full circle this big
+		 */
+		void arc(float x, float y, float inner, float outer, float start, float sweep, SDL_Color color) {
+			if (outer <= 0.0f || inner >= outer || sweep == 0.0f)
+				return;
+
+			constexpr float tau = 2.0f * static_cast<float>(M_PI);
+			sweep = std::clamp(sweep, -tau, tau);
+			const int full = circleMeshes().forRadius(outer).segments;
+			const int steps = std::max(1, static_cast<int>(std::ceil(full * std::abs(sweep) / tau)));
+
+			// walk the arc by rotating one unit vector, two sin / cos pairs however long it is
+			const float stepAngle = sweep / steps;
+			const float sc = std::cos(stepAngle), ss = std::sin(stepAngle);
+			float ux = std::cos(start), uy = std::sin(start);
+
+			int base = static_cast<int>(vertices.size());
+			if (inner <= 0.0f) {
+				vertices.push_back({{x, y}, color, {0.0f, 0.0f}});
+				for (int i = 0; i <= steps; ++i) {
+					vertices.push_back({{x + ux * outer, y + uy * outer}, color, {0.0f, 0.0f}});
+					float nx = ux * sc - uy * ss;
+					uy = ux * ss + uy * sc;
+					ux = nx;
+				}
+				for (int i = 0; i < steps; ++i)
+					indices.insert(indices.end(), {base, base + 1 + i, base + 2 + i});
+			} else {
+				for (int i = 0; i <= steps; ++i) {
+					vertices.push_back({{x + ux * inner, y + uy * inner}, color, {0.0f, 0.0f}});
+					vertices.push_back({{x + ux * outer, y + uy * outer}, color, {0.0f, 0.0f}});
+					float nx = ux * sc - uy * ss;
+					uy = ux * ss + uy * sc;
+					ux = nx;
+				}
+				for (int i = 0; i < steps; ++i) {
+					int a = base + i * 2;
+					indices.insert(indices.end(), {a, a + 1, a + 3, a, a + 3, a + 2});
+				}
+			}
+			++shapeCount;
+		}
+
+		// everything queued since the last flush, in one call; blend is set for it and put back after
+		void flush(SDL_Renderer *ren, SDL_BlendMode blend = SDL_BLENDMODE_BLEND) {
+			lastStats = {shapeCount, vertices.size(), 0};
+
+			if (!indices.empty()) {
+				SDL_BlendMode previous;
+				SDL_GetRenderDrawBlendMode(ren, &previous);
+				SDL_SetRenderDrawBlendMode(ren, blend);
+				SDL_RenderGeometry(ren, nullptr, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+				SDL_SetRenderDrawBlendMode(ren, previous);
+				++lastStats.drawCalls;
+			}
+
+			vertices.clear();
+			indices.clear();
+			shapeCount = 0;
+		}
+
+		const Stats &stats() const noexcept { return lastStats; }
+
+	private:
+		void append(const std::vector<int> &pattern, int base) {
+			size_t first = indices.size();
+			indices.resize(first + pattern.size());
+			for (size_t i = 0; i < pattern.size(); ++i)
+				indices[first + i] = pattern[i] + base;
+			++shapeCount;
+		}
+
+	private:
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+		size_t shapeCount {0};
+		Stats lastStats;
+	};
+
+	// one-off versions, each is its own draw call; queue on a ShapeBatch when drawing many
+	inline void drawCircle(SDL_Renderer *ren, float x, float y, float radius, SDL_Color color = {255, 255, 255, 255}) {
+		static ShapeBatch batch;
+		batch.circle(x, y, radius, color);
+		batch.flush(ren);
+	}
+
+	inline void drawGlow(SDL_Renderer *ren, float x, float y, float radius, SDL_Color color = {255, 255, 255, 255}) {
+		static ShapeBatch batch;
+		batch.glow(x, y, radius, color);
+		batch.flush(ren);
+	}
+} // namespace gmtk
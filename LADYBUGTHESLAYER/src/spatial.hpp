@@ -0,0 +1,202 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Spatial hash over uniform cells for broadphase collision queries
+	 * Boxes are bucketed into every cell they overlap, so a query only looks at its neighbourhood
+	 */
+	class SpatialGrid {
+	public:
+		using Proxy = uint32_t;
+		static constexpr Proxy invalid = UINT32_MAX;
+
+		explicit SpatialGrid(float cellSize = 64.0f) : cellSize(cellSize), invCellSize(1.0f / cellSize) {}
+
+		Proxy insert(const SDL_FRect &box, uint32_t userData = 0) {
+			Proxy id;
+			if (!freeList.empty()) {
+				id = freeList.back();
+				freeList.pop_back();
+			} else {
+				id = static_cast<Proxy>(objects.size());
+				objects.emplace_back();
+			}
+
+			auto &obj = objects[id];
+			obj.box = box;
+			obj.cells = cellRange(box);
+			obj.userData = userData;
+			obj.stamp = 0;
+			obj.alive = true;
+			link(id, obj.cells);
+			++liveCount;
+
+			return id;
+		}
+
+		void move(Proxy id, const SDL_FRect &box) {
+			if (!valid(id))
+				return;
+
+			auto &obj = objects[id];
+			obj.box = box;
+
+			// most moves stay inside the same cells so the buckets can be left alone
+			SDL_Rect cells = cellRange(box);
+			if (cells.x == obj.cells.x && cells.y == obj.cells.y && cells.w == obj.cells.w && cells.h == obj.cells.h)
+				return;
+
+			unlink(id, obj.cells);
+			obj.cells = cells;
+			link(id, obj.cells);
+		}
+
+		void remove(Proxy id) {
+			if (!valid(id))
+				return;
+
+			auto &obj = objects[id];
+			unlink(id, obj.cells);
+			obj.alive = false;
+			freeList.push_back(id);
+			--liveCount;
+		}
+
+		// calls fn(proxy) once for every box overlapping area
+		template <typename F>
+		void query(const SDL_FRect &area, F &&fn) {
+			SDL_Rect range = cellRange(area);
+
+			if (++queryStamp == 0) {
+				// stamp wrapped around, reset so stale stamps can't match
+				for (auto &obj : objects)
+					obj.stamp = 0;
+				queryStamp = 1;
+			}
+
+			for (int cy = range.y; cy <= range.h; ++cy) {
+				for (int cx = range.x; cx <= range.w; ++cx) {
+					auto it = cells.find(key(cx, cy));
+					if (it == cells.end())
+						continue;
+
+					for (Proxy id : it->second) {
+						auto &obj = objects[id];
+						if (obj.stamp == queryStamp)
+							continue;
+
+						obj.stamp = queryStamp;
+						if (SDL_HasIntersectionF(&obj.box, &area))
+							fn(id);
+					}
+				}
+			}
+		}
+
+		/**
+		 * Same result as query() but leaves the grid untouched, so several threads can run it at once
+		 * Duplicates are skipped by only reporting a box from the first cell it shares with area
+		 */
+		template <typename F>
+		void queryShared(const SDL_FRect &area, F &&fn) const {
+			SDL_Rect range = cellRange(area);
+
+			for (int cy = range.y; cy <= range.h; ++cy) {
+				for (int cx = range.x; cx <= range.w; ++cx) {
+					auto it = cells.find(key(cx, cy));
+					if (it == cells.end())
+						continue;
+
+					for (Proxy id : it->second) {
+						const auto &obj = objects[id];
+						if (cx != std::max(range.x, obj.cells.x) || cy != std::max(range.y, obj.cells.y))
+							continue;
+
+						if (SDL_HasIntersectionF(&obj.box, &area))
+							fn(id);
+					}
+				}
+			}
+		}
+
+		void query(const SDL_FRect &area, std::vector<Proxy> &out) {
+			query(area, [&out](Proxy id) { out.push_back(id); });
+		}
+
+		bool valid(Proxy id) const noexcept { return id < objects.size() && objects[id].alive; }
+		const SDL_FRect &box(Proxy id) const { return objects[id].box; }
+		uint32_t userData(Proxy id) const { return objects[id].userData; }
+		size_t size() const noexcept { return liveCount; }
+
+		void clear() {
+			cells.clear();
+			objects.clear();
+			freeList.clear();
+			liveCount = 0;
+		}
+
+	private:
+		struct Object {
+			SDL_FRect box;
+			SDL_Rect cells; // x/y is the first cell, w/h the last one (inclusive)
+			uint32_t userData;
+			uint32_t stamp;
+			bool alive;
+		};
+
+		static uint64_t key(int cx, int cy) noexcept {
+			return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+		}
+
+		SDL_Rect cellRange(const SDL_FRect &box) const noexcept {
+			return {
+				static_cast<int>(std::floor(box.x * invCellSize)),
+				static_cast<int>(std::floor(box.y * invCellSize)),
+				static_cast<int>(std::floor((box.x + box.w) * invCellSize)),
+				static_cast<int>(std::floor((box.y + box.h) * invCellSize)),
+			};
+		}
+
+		void link(Proxy id, const SDL_Rect &range) {
+			for (int cy = range.y; cy <= range.h; ++cy) {
+				for (int cx = range.x; cx <= range.w; ++cx)
+					cells[key(cx, cy)].push_back(id);
+			}
+		}
+
+		void unlink(Proxy id, const SDL_Rect &range) {
+			for (int cy = range.y; cy <= range.h; ++cy) {
+				for (int cx = range.x; cx <= range.w; ++cx) {
+					auto it = cells.find(key(cx, cy));
+					if (it == cells.end())
+						continue;
+
+					auto &bucket = it->second;
+					for (size_t i = 0; i < bucket.size(); ++i) {
+						if (bucket[i] == id) {
+							bucket[i] = bucket.back();
+							bucket.pop_back();
+							break;
+						}
+					}
+				}
+			}
+		}
+
+	private:
+		float cellSize;
+		float invCellSize;
+		std::unordered_map<uint64_t, std::vector<Proxy>> cells;
+		std::vector<Object> objects;
+		std::vector<Proxy> freeList;
+		size_t liveCount {0};
+		uint32_t queryStamp {0};
+	};
+} // namespace gmtk
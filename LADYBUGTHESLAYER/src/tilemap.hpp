@@ -0,0 +1,211 @@
+#pragma once
+
+#include <SDL.h>
+#include "camera.hpp"
+#include "helper.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gmtk {
+	/**
+	 * Flat grid of tile ids that bakes itself into chunked render targets
+	 * Only chunks with a changed tile get redrawn; drawing the map is one blit per chunk
+	 */
+	class TileMap {
+	public:
+		static constexpr uint16_t empty = 0;
+
+		TileMap(int columns, int rows, int tileSize, int chunkTiles = 64)
+			: cols(columns), rowCount(rows), size(tileSize), chunkTiles(chunkTiles) {
+			tiles.assign(static_cast<size_t>(cols) * rowCount, empty);
+			types.resize(1); // id 0 is always empty space
+
+			chunkCols = (cols + chunkTiles - 1) / chunkTiles;
+			chunkRows = (rowCount + chunkTiles - 1) / chunkTiles;
+			chunks.resize(static_cast<size_t>(chunkCols) * chunkRows);
+		}
+
+		// clip left empty uses the whole texture
+		void setTileType(uint16_t id, Texture tex, SDL_Rect clip = {0, 0, 0, 0}, bool solid = true) {
+			if (id == empty)
+				return;
+
+			if (id >= types.size())
+				types.resize(id + 1);
+
+			types[id] = {tex, clip, solid};
+			invalidate();
+		}
+
+		void set(int col, int row, uint16_t id) {
+			if (!contains(col, row))
+				return;
+
+			auto &tile = tiles[static_cast<size_t>(row) * cols + col];
+			if (tile == id)
+				return;
+
+			tile = id;
+			chunks[static_cast<size_t>(row / chunkTiles) * chunkCols + col / chunkTiles].dirty = true;
+		}
+
+		uint16_t get(int col, int row) const noexcept {
+			return contains(col, row) ? tiles[static_cast<size_t>(row) * cols + col] : empty;
+		}
+
+		bool isSolid(int col, int row) const noexcept {
+			uint16_t id = get(col, row);
+			return id != empty && id < types.size() && types[id].solid;
+		}
+
+		bool contains(int col, int row) const noexcept {
+			return col >= 0 && row >= 0 && col < cols && row < rowCount;
+		}
+
+		// render targets lose their contents on SDL_RENDER_TARGETS_RESET, so everything gets rebaked
+		void invalidate() noexcept {
+			for (auto &chunk : chunks)
+				chunk.dirty = true;
+		}
+
+		void bake(SDL_Renderer *ren) {
+			bake(ren, 0, 0, chunkCols - 1, chunkRows - 1);
+		}
+
+		void draw(SDL_Renderer *ren, int x = 0, int y = 0) {
+			drawnChunks = 0;
+			bake(ren);
+
+			for (int cy = 0; cy < chunkRows; ++cy) {
+				for (int cx = 0; cx < chunkCols; ++cx) {
+					auto &chunk = chunks[static_cast<size_t>(cy) * chunkCols + cx];
+					if (chunk.target == nullptr)
+						continue;
+
+					drawTexture(chunk.target.get(), ren, x + cx * chunkTiles * size, y + cy * chunkTiles * size);
+					++drawnChunks;
+				}
+			}
+		}
+
+		// only chunks overlapping the camera view are baked and drawn, so map size doesn't matter
+		void draw(SDL_Renderer *ren, const Camera2D &cam) {
+			SDL_FRect view = cam.view();
+			float chunkSize = static_cast<float>(chunkTiles * size);
+
+			int firstX = std::max(static_cast<int>(std::floor(view.x / chunkSize)), 0);
+			int firstY = std::max(static_cast<int>(std::floor(view.y / chunkSize)), 0);
+			int lastX = std::min(static_cast<int>(std::floor((view.x + view.w) / chunkSize)), chunkCols - 1);
+			int lastY = std::min(static_cast<int>(std::floor((view.y + view.h) / chunkSize)), chunkRows - 1);
+
+			drawnChunks = 0;
+			bake(ren, firstX, firstY, lastX, lastY);
+
+			for (int cy = firstY; cy <= lastY; ++cy) {
+				for (int cx = firstX; cx <= lastX; ++cx) {
+					auto &chunk = chunks[static_cast<size_t>(cy) * chunkCols + cx];
+					if (chunk.target == nullptr)
+						continue;
+
+					int w, h;
+					SDL_QueryTexture(chunk.target.get(), nullptr, nullptr, &w, &h);
+					SDL_FRect dst = cam.worldToScreen(SDL_FRect {cx * chunkSize, cy * chunkSize, (float)w, (float)h});
+					SDL_RenderCopyF(ren, chunk.target.get(), nullptr, &dst);
+					++drawnChunks;
+				}
+			}
+		}
+
+		int columns() const noexcept { return cols; }
+		int rows() const noexcept { return rowCount; }
+		int tileSize() const noexcept { return size; }
+		int chunkCount() const noexcept { return chunkCols * chunkRows; }
+		int chunksDrawn() const noexcept { return drawnChunks; }
+
+	private:
+		struct TileType {
+			Texture tex;
+			SDL_Rect clip;
+			bool solid;
+		};
+
+		struct Chunk {
+			Texture target;
+			bool dirty {true};
+		};
+
+		// rebakes the dirty chunks in an inclusive chunk range
+		void bake(SDL_Renderer *ren, int firstX, int firstY, int lastX, int lastY) {
+			SDL_Texture *oldTarget = nullptr;
+			Uint8 r = 0, g = 0, b = 0, a = 0;
+			bool switched = false;
+
+			for (int cy = firstY; cy <= lastY; ++cy) {
+				for (int cx = firstX; cx <= lastX; ++cx) {
+					auto &chunk = chunks[static_cast<size_t>(cy) * chunkCols + cx];
+					if (!chunk.dirty)
+						continue;
+
+					// bakeChunk clears with transparent black, the caller's color comes back with its target
+					if (!switched) {
+						oldTarget = SDL_GetRenderTarget(ren);
+						SDL_GetRenderDrawColor(ren, &r, &g, &b, &a);
+						switched = true;
+					}
+
+					bakeChunk(ren, chunk, cx, cy);
+				}
+			}
+
+			if (switched) {
+				SDL_SetRenderTarget(ren, oldTarget);
+				SDL_SetRenderDrawColor(ren, r, g, b, a);
+			}
+		}
+
+		void bakeChunk(SDL_Renderer *ren, Chunk &chunk, int cx, int cy) {
+			int firstCol = cx * chunkTiles, firstRow = cy * chunkTiles;
+			int lastCol = std::min(firstCol + chunkTiles, cols), lastRow = std::min(firstRow + chunkTiles, rowCount);
+
+			if (chunk.target == nullptr) {
+				int w = (lastCol - firstCol) * size, h = (lastRow - firstRow) * size;
+				chunk.target = Texture(SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h), SDL_DestroyTexture);
+				if (chunk.target == nullptr) {
+					std::cout << "Tile chunk failed to be created: " << SDL_GetError() << '\n';
+					return;
+				}
+				SDL_SetTextureBlendMode(chunk.target.get(), SDL_BLENDMODE_BLEND);
+			}
+
+			SDL_SetRenderTarget(ren, chunk.target.get());
+			SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+			SDL_RenderClear(ren);
+
+			for (int row = firstRow; row < lastRow; ++row) {
+				for (int col = firstCol; col < lastCol; ++col) {
+					uint16_t id = tiles[static_cast<size_t>(row) * cols + col];
+					if (id == empty || id >= types.size() || types[id].tex == nullptr)
+						continue;
+
+					auto &type = types[id];
+					SDL_Rect *clip = (type.clip.w > 0 && type.clip.h > 0) ? &type.clip : nullptr;
+					drawTexture(type.tex.get(), ren, (col - firstCol) * size, (row - firstRow) * size, clip);
+				}
+			}
+
+			chunk.dirty = false;
+		}
+
+	private:
+		int cols, rowCount;
+		int size;
+		int chunkTiles;
+		int chunkCols, chunkRows;
+		int drawnChunks {0};
+		std::vector<uint16_t> tiles;
+		std::vector<TileType> types;
+		std::vector<Chunk> chunks;
+	};
+} // namespace gmtk